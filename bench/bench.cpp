@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include <physfs.h>
+
+#include "bench.h"
+#include "bench_report.h"
+#include "game_server.h"
+#include "net_relay.h"
+#include "recording_render.h"
+#include "rml.h"
+
+using namespace yojimbo;
+
+// Engine hot path microbenchmarks, run by `zig build bench`.
+//
+//     bench [--iterations N] [--suite NAME] [--json results.json]
+//           [--baseline baseline.json] [--tolerance 0.25] [--min-delta 0.002]
+//           [--clients N] [--entities N] [--net-... conditions]
+//
+// Suites, all by default or the one given with --suite:
+//
+//     keys       raylib to RmlUi key translation
+//     render     RenderGeometry vertex emission into the recording backend
+//     files      PhysFS reads through GameFileInterface, from the page cache
+//     serialize  yojimbo message serialization, both directions
+//     server     GameServer ticks with synthetic yojimbo clients on loopback
+//
+// --net-... options (see net_sim.h) put the synthetic clients behind a
+// simulated network, relayed outside the timed part of the tick.
+//
+// --json writes the results, see BenchReport. With --baseline, cases whose
+// median is slower than the baseline's by more than --tolerance (a fraction)
+// and --min-delta milliseconds are listed and the exit status is 2, which
+// fails CI. A baseline only means something for the machine it was recorded
+// on: record it on the CI runner, with --json.
+
+static volatile unsigned sink;
+
+static void bench_keys(Bench &bench, int iterations)
+{
+	const int rounds = 1000;
+	bench.Run("translate all keys x1000", iterations, [&] {
+		unsigned sum = 0;
+		for (int round = 0; round < rounds; round++)
+			for (int key = KEY_NULL; key <= KEY_KB_MENU; key++) sum += raylib_key_to_identifier(static_cast<KeyboardKey>(key));
+		sink = sum;
+	});
+	bench.Counter("keys per round", KEY_KB_MENU + 1);
+}
+
+// Quads as RmlUi generates them, two triangles over four vertices.
+static void make_quads(std::vector<Rml::Vertex> &vertices, std::vector<int> &indices, int count, float size, int columns)
+{
+	vertices.clear();
+	indices.clear();
+	for (int i = 0; i < count; i++) {
+		const float x = (i % columns) * size, y = (i / columns) * size;
+		const int	base = static_cast<int>(vertices.size());
+		for (int corner = 0; corner < 4; corner++) {
+			Rml::Vertex vertex;
+			vertex.position	 = {x + (corner & 1) * size, y + (corner >> 1) * size};
+			vertex.colour	 = Rml::Colourb(255, 255, 255, 255);
+			vertex.tex_coord = {static_cast<float>(corner & 1), static_cast<float>(corner >> 1)};
+			vertices.push_back(vertex);
+		}
+		for (int index : {0, 1, 2, 2, 1, 3}) indices.push_back(base + index);
+	}
+}
+
+static void bench_render(Bench &bench, int iterations)
+{
+	RecordingRenderInterface render;
+	render.SetViewport(1280, 720);
+
+	// A page of text: one call per text element, many glyph quads each.
+	std::vector<Rml::Vertex> text_vertices;
+	std::vector<int>		 text_indices;
+	make_quads(text_vertices, text_indices, 2000, 8.0f, 160);
+	bench.Run("text, 2000 quads in 1 call", iterations, [&] {
+		render.BeginFrame();
+		render.RenderGeometry(text_vertices.data(), static_cast<int>(text_vertices.size()), text_indices.data(),
+							  static_cast<int>(text_indices.size()), 1, {0, 0});
+		render.EndFrame();
+	});
+	bench.Counter("text vertices per frame", render.GetFrameStats().vertices);
+
+	// Decorated boxes: many calls of a few quads, alternating textures.
+	std::vector<Rml::Vertex> box_vertices;
+	std::vector<int>		 box_indices;
+	make_quads(box_vertices, box_indices, 9, 4.0f, 3);
+	bench.Run("boxes, 500 calls of 9 quads", iterations, [&] {
+		render.BeginFrame();
+		for (int i = 0; i < 500; i++)
+			render.RenderGeometry(box_vertices.data(), static_cast<int>(box_vertices.size()), box_indices.data(),
+								  static_cast<int>(box_indices.size()), 1 + i % 2,
+								  {static_cast<float>(i % 50 * 24), static_cast<float>(i / 50 * 24)});
+		render.EndFrame();
+	});
+	bench.Counter("box vertices per frame", render.GetFrameStats().vertices);
+	bench.Counter("box texture binds per frame", render.GetFrameStats().texture_binds);
+
+	// The same boxes scrolled out of the viewport, culled before emission.
+	bench.Run("boxes, 500 calls culled", iterations, [&] {
+		render.BeginFrame();
+		for (int i = 0; i < 500; i++)
+			render.RenderGeometry(box_vertices.data(), static_cast<int>(box_vertices.size()), box_indices.data(),
+								  static_cast<int>(box_indices.size()), 1, {static_cast<float>(i % 50 * 24), 2000.0f});
+		render.EndFrame();
+	});
+}
+
+static bool bench_files(Bench &bench, int iterations, GameFileInterface &file_interface)
+{
+	const int	 files = 200, file_bytes = 16 << 10, large_bytes = 8 << 20;
+	const size_t chunk = 64 << 10;
+
+	// Written to the user's write directory, removed again at the end.
+	const char				*large_path = "cache/bench/files/large.bin";
+	std::vector<std::string> paths;
+	auto					 remove_files = [&] {
+		for (const auto &path : paths) PHYSFS_delete(path.c_str());
+		PHYSFS_delete(large_path);
+		PHYSFS_delete("cache/bench/files");
+		PHYSFS_delete("cache/bench");
+	};
+
+	std::vector<unsigned char> contents(large_bytes);
+	for (int i = 0; i < large_bytes; i++) contents[i] = static_cast<unsigned char>(i * 31 + i / 4096);
+	for (int i = 0; i < files; i++) {
+		paths.push_back(Rml::CreateString(64, "cache/bench/files/%04d.bin", i));
+		if (!save_file_data(paths.back().c_str(), contents.data() + i, file_bytes)) {
+			remove_files();
+			return false;
+		}
+	}
+	if (!save_file_data(large_path, contents.data(), large_bytes)) {
+		remove_files();
+		return false;
+	}
+
+	std::vector<unsigned char> buffer(std::max<size_t>(file_bytes, chunk));
+	size_t					   failed = 0;
+
+	bench.Run("200 files of 16 KiB", iterations, [&] {
+		for (const auto &path : paths) {
+			Rml::FileHandle file = file_interface.Open(path);
+			failed += !file || file_interface.Read(buffer.data(), file_bytes, file) != static_cast<size_t>(file_bytes);
+			if (file) file_interface.Close(file);
+		}
+	});
+	const double small_ms = bench.GetResults().back().ms.p50;
+
+	bench.Run("8 MiB file, 64 KiB reads", iterations, [&] {
+		Rml::FileHandle file = file_interface.Open(large_path);
+		if (!file) {
+			failed++;
+			return;
+		}
+		size_t total = 0;
+		while (size_t read = file_interface.Read(buffer.data(), chunk, file)) total += read;
+		failed += total != static_cast<size_t>(large_bytes);
+		file_interface.Close(file);
+	});
+	const double large_ms = bench.GetResults().back().ms.p50;
+	remove_files();
+
+	const double mib = 1024.0 * 1024.0;
+	if (small_ms > 0) bench.Counter("small files MiB/s", files * file_bytes / mib / (small_ms / 1000.0));
+	if (large_ms > 0) bench.Counter("large file MiB/s", large_bytes / mib / (large_ms / 1000.0));
+	bench.Counter("failed reads", failed);
+	return failed == 0;
+}
+
+// A batch of messages as the reliable endpoint packs them: type, then body.
+template <typename Stream>
+static bool serialize_messages(Stream &stream, MessageFactory &factory, Message **messages, int count)
+{
+	for (int i = 0; i < count; i++) {
+		int32_t type = Stream::IsWriting ? messages[i]->GetType() : 0;
+		if (!stream.SerializeInteger(type, 0, NUM_TEST_MESSAGE_TYPES - 1)) return false;
+		if (Stream::IsReading) messages[i] = factory.CreateMessage(type);
+		if (!messages[i] || !messages[i]->SerializeInternal(stream)) return false;
+	}
+	return true;
+}
+
+static bool bench_serialize(Bench &bench, int iterations)
+{
+	const int		  count = 256;
+	TestMessageFactory factory(GetDefaultAllocator());
+
+	std::vector<Message *> sent(count), received(count);
+	for (int i = 0; i < count; i++) {
+		auto *message	  = static_cast<TestMessage *>(factory.CreateMessage(TEST_MESSAGE));
+		message->sequence = static_cast<uint16_t>(i * 7);
+		sent[i]			  = message;
+	}
+
+	std::vector<uint32_t> buffer(64 << 10);	 // words, streams work on 32 bit words
+	const int			  buffer_bytes = static_cast<int>(buffer.size() * sizeof(uint32_t));
+	int					  bytes		   = 0;
+	int					  failed	   = 0;
+
+	bench.Run("write 256 messages", iterations, [&] {
+		WriteStream stream(GetDefaultAllocator(), reinterpret_cast<uint8_t *>(buffer.data()), buffer_bytes);
+		failed += !serialize_messages(stream, factory, sent.data(), count);
+		stream.Flush();
+		bytes = stream.GetBytesProcessed();
+	});
+
+	bench.Run("read 256 messages", iterations, [&] {
+		ReadStream stream(GetDefaultAllocator(), reinterpret_cast<const uint8_t *>(buffer.data()), bytes);
+		std::fill(received.begin(), received.end(), nullptr);
+		failed += !serialize_messages(stream, factory, received.data(), count);
+		for (Message *message : received)
+			if (message) factory.ReleaseMessage(message);
+	});
+
+	for (Message *message : sent) factory.ReleaseMessage(message);
+
+	bench.Counter("bytes per batch", bytes);
+	bench.Counter("failed batches", failed);
+	return failed == 0;
+}
+
+static bool bench_server(Bench &bench, int iterations, int client_count, int entities, const NetSimConfig &conditions)
+{
+	const double	   delta_time = 0.01;
+	ClientServerConfig connection_config;
+	uint8_t			   private_key[KeyBytes] = {};
+	const Address	   address("127.0.0.1", ServerPort + 100);
+
+	GameServer::Config config;
+	config.maxClients  = client_count;
+	config.checkpoints = false;
+
+	// The token lists the relay to connect to and the server it accepts;
+	// opened first so a failure leaves no server running.
+	NetRelay relay(NetRelay::Config::Symmetric(conditions));
+	Address	 addresses[2]  = {address, address};
+	int		 address_count = 1;
+	if (conditions.IsActive()) {
+		if (!relay.Open(0, "127.0.0.1", address.GetPort())) return false;
+		addresses[0]  = Address("127.0.0.1", relay.GetPort());
+		address_count = 2;
+	}
+
+	GameServer server(GetDefaultAllocator(), private_key, address, connection_config, config, 100.0);
+	server.Start();
+
+	srand(1);
+	auto random_fixed = [] { return Fixed::FromRaw(rand() % (Fixed::One * 64) - Fixed::One * 32); };
+	for (int i = 0; i < entities; i++)
+		server.GetWorld().Spawn(static_cast<uint16_t>(i % 8), {random_fixed(), random_fixed()}, {random_fixed(), random_fixed()});
+
+	std::vector<std::unique_ptr<Client>> clients;
+	for (int i = 0; i < client_count; i++) {
+		clients.emplace_back(new Client(GetDefaultAllocator(), Address("0.0.0.0"), connection_config, adapter, server.GetTime()));
+		clients.back()->InsecureConnect(private_key, 1000 + i, addresses, address_count);
+	}
+
+	// One tick of the synthetic clients around one of the server; each
+	// connected client sends a message per tick.
+	auto tick = [&](std::vector<double> *samples_ms) {
+		for (auto &client : clients) {
+			if (client->IsConnected() && client->CanSendMessage(UnreliableChannel)) {
+				auto *message	  = static_cast<TestMessage *>(client->CreateMessage(TEST_MESSAGE));
+				message->sequence = static_cast<uint16_t>(server.GetWorld().GetTick());
+				client->SendMessage(UnreliableChannel, message);
+			}
+			client->SendPackets();
+		}
+		relay.Update(server.GetTime());
+
+		auto start = Bench::Clock::now();
+		server.Tick(delta_time);
+		if (samples_ms)
+			samples_ms->push_back(std::chrono::duration<double, std::milli>(Bench::Clock::now() - start).count());
+		relay.Update(server.GetTime());
+
+		for (auto &client : clients) {
+			client->ReceivePackets();
+			for (int channel = 0; channel < connection_config.numChannels; channel++)
+				while (Message *message = client->ReceiveMessage(channel)) client->ReleaseMessage(message);
+			client->AdvanceTime(server.GetTime());
+		}
+	};
+
+	for (int i = 0; i < 1000 && server.GetClients().GetActiveCount() < client_count; i++) tick(nullptr);
+	const int connected = server.GetClients().GetActiveCount();
+
+	std::vector<double> samples_ms;
+	samples_ms.reserve(iterations);
+	for (int i = 0; i < iterations; i++) tick(&samples_ms);
+	bench.Record(Rml::CreateString(64, "tick, %d clients, %d entities", client_count, entities), samples_ms);
+	bench.Counter("clients connected", connected);
+	if (conditions.IsActive()) {
+		bench.Counter("packets lost", relay.GetUpstreamStats().lost + relay.GetUpstreamStats().burst_lost +
+										  relay.GetDownstreamStats().lost + relay.GetDownstreamStats().burst_lost);
+	}
+
+	for (auto &client : clients) client->Disconnect();
+	clients.clear();
+	server.Stop();
+	return connected == client_count;
+}
+
+int main(int argc, char *argv[])
+{
+	int			iterations = 200;
+	const char *suite	   = nullptr;
+	const char *json_path  = nullptr;
+	const char *baseline   = nullptr;
+	double		tolerance  = 0.25;
+	double		min_delta  = 0.002;
+	int			clients	   = 16;
+	int			entities   = 10000;
+
+	NetSimConfig conditions;
+	for (int i = 1; i < argc; i++) {
+		if (net_sim_parse_arg(conditions, argc, argv, i))
+			continue;
+		else if (!strcmp(argv[i], "--iterations") && i + 1 < argc)
+			iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--suite") && i + 1 < argc)
+			suite = argv[++i];
+		else if (!strcmp(argv[i], "--json") && i + 1 < argc)
+			json_path = argv[++i];
+		else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+			baseline = argv[++i];
+		else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+			tolerance = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--min-delta") && i + 1 < argc)
+			min_delta = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--clients") && i + 1 < argc)
+			clients = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--entities") && i + 1 < argc)
+			entities = atoi(argv[++i]);
+	}
+	auto selected = [&](const char *name) { return !suite || !strcmp(suite, name); };
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	BenchReport report;
+	bool		ok = true;
+
+	if (selected("keys")) {
+		Bench bench("keys");
+		bench_keys(bench, iterations);
+		bench.Print();
+		report.Add(bench);
+	}
+
+	if (selected("render")) {
+		Bench bench("render");
+		bench_render(bench, iterations);
+		bench.Print();
+		report.Add(bench);
+	}
+
+	if (selected("files")) {
+		GameFileInterface file_interface(argv);
+		if (!file_interface.set_write_dir("mlge", "mlge")) {
+			fprintf(stderr, "error: no write directory\n");
+			return 1;
+		}
+
+		Bench bench("files");
+		if (!bench_files(bench, iterations, file_interface)) {
+			fprintf(stderr, "error: file reads failed\n");
+			ok = false;
+		}
+		bench.Print();
+		report.Add(bench);
+	}
+
+	if (selected("serialize") || selected("server")) {
+		if (!InitializeYojimbo()) {
+			fprintf(stderr, "error: failed to initialize yojimbo\n");
+			return 1;
+		}
+		yojimbo_log_level(YOJIMBO_LOG_LEVEL_NONE);
+
+		if (selected("serialize")) {
+			Bench bench("serialize");
+			if (!bench_serialize(bench, iterations)) {
+				fprintf(stderr, "error: message serialization failed\n");
+				ok = false;
+			}
+			bench.Print();
+			report.Add(bench);
+		}
+
+		if (selected("server")) {
+			Bench bench("server");
+			if (!bench_server(bench, iterations, clients, entities, conditions)) {
+				fprintf(stderr, "error: not all synthetic clients connected\n");
+				ok = false;
+			}
+			bench.Print();
+			report.Add(bench);
+		}
+
+		ShutdownYojimbo();
+	}
+
+	if (json_path && !report.Write(json_path)) {
+		fprintf(stderr, "error: cannot write %s\n", json_path);
+		return 1;
+	}
+
+	if (baseline) {
+		BenchReport before;
+		if (!before.Load(baseline)) {
+			fprintf(stderr, "error: cannot read baseline %s\n", baseline);
+			return 1;
+		}
+
+		auto regressions = report.Compare(before, tolerance, min_delta);
+		for (const auto &regression : regressions)
+			printf("REGRESSION %s: p50 %.4f ms -> %.4f ms (%+.0f %%)\n", regression.name.c_str(), regression.baseline_ms,
+				   regression.current_ms, (regression.current_ms / regression.baseline_ms - 1.0) * 100.0);
+		printf("%d of %d cases regressed against %s\n", static_cast<int>(regressions.size()),
+			   static_cast<int>(report.GetCases().size()), baseline);
+		if (!regressions.empty()) return 2;
+	}
+
+	return ok ? 0 : 1;
+}
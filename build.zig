@@ -27,12 +27,26 @@ pub fn build(b: *std.Build) void {
         "-std=c++17",
         "-fno-rtti",
     };
+    // The client side uses coroutines.
+    const client_cxxflags = flags ++ [_][]const u8{
+        "-std=c++20",
+        "-fno-rtti",
+    };
+
+    const io_uring = b.option(bool, "io-uring", "Read assets with io_uring (Linux, needs liburing)") orelse false;
 
     // --- vendor ---
 
     const raylib = raylib_build.addRaylib(b, target, optimize);
     raylib.defineCMacro("SUPPORT_FILEFORMAT_TGA", null);
     raylib.defineCMacro("SUPPORT_FILEFORMAT_JPG", null);
+    // raylib's allocations, stb and its other single-header libraries
+    // included, go to the graphics memory tag (shared/memtrack.h). The
+    // statement expressions declare the hooks where raylib.h does not.
+    raylib.defineCMacro("RL_MALLOC(sz)", "({ extern void *mem_graphics_malloc(__SIZE_TYPE__); mem_graphics_malloc(sz); })");
+    raylib.defineCMacro("RL_CALLOC(n,sz)", "({ extern void *mem_graphics_calloc(__SIZE_TYPE__, __SIZE_TYPE__); mem_graphics_calloc(n, sz); })");
+    raylib.defineCMacro("RL_REALLOC(ptr,sz)", "({ extern void *mem_graphics_realloc(void *, __SIZE_TYPE__); mem_graphics_realloc(ptr, sz); })");
+    raylib.defineCMacro("RL_FREE(ptr)", "({ extern void mem_graphics_free(void *); mem_graphics_free(ptr); })");
     const yojimbo = ext_build.addYojimbo(b, target, optimize);
     const rmlui = ext_build.addRmlUi(b, target, optimize) catch |err|
         std.debug.panic("RmlUi build failed: {}", .{err});
@@ -47,12 +61,71 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
 
+    shared.addCSourceFiles(&.{
+        "shared/send_scheduler.cpp",
+        "shared/compress.cpp",
+        "shared/compress_dict.cpp",
+        "shared/client_table.cpp",
+        "shared/fixed.cpp",
+        "shared/spatial_grid.cpp",
+        "shared/entity_store.cpp",
+        "shared/checkpoint.cpp",
+        "shared/memtrack.cpp",
+        "shared/bench_report.cpp",
+        "shared/net_sim.cpp",
+        "shared/net_relay.cpp",
+        "shared/admin_socket.cpp",
+    }, &cxxflags);
+    shared.linkLibCpp();
+    shared.linkSystemLibrary("zstd");
+
     const shared_tests = b.addTest(.{
         .root_source_file = .{ .path = "shared/main.zig" },
         .target = target,
         .optimize = optimize,
     });
 
+    const shared_cpp_tests = [_]*std.Build.CompileStep{
+        addCppTest(b, "send_scheduler_test", "shared/send_scheduler_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "compress_test", "shared/compress_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "fixed_test", "shared/fixed_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "client_table_test", "shared/client_table_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "spatial_grid_test", "shared/spatial_grid_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "checkpoint_test", "shared/checkpoint_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "memtrack_test", "shared/memtrack_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "bench_report_test", "shared/bench_report_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "net_sim_test", "shared/net_sim_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "net_relay_test", "shared/net_relay_test.cpp", shared, target, optimize, &cxxflags),
+        addCppTest(b, "admin_socket_test", "shared/admin_socket_test.cpp", shared, target, optimize, &cxxflags),
+    };
+
+    const fixed_bench = addCppTest(b, "fixed_bench", "shared/fixed_bench.cpp", shared, target, optimize, &cxxflags);
+    const fixed_bench_cmd = fixed_bench.run();
+    if (b.args) |args| {
+        fixed_bench_cmd.addArgs(args);
+    }
+
+    const fixed_bench_step = b.step("bench-fixed", "Run the fixed point math benchmark");
+    fixed_bench_step.dependOn(&fixed_bench_cmd.step);
+
+    const client_table_bench = addCppTest(b, "client_table_bench", "shared/client_table_bench.cpp", shared, target, optimize, &cxxflags);
+    const client_table_bench_cmd = client_table_bench.run();
+    if (b.args) |args| {
+        client_table_bench_cmd.addArgs(args);
+    }
+
+    const client_table_bench_step = b.step("bench-clients", "Run the connection slot benchmark");
+    client_table_bench_step.dependOn(&client_table_bench_cmd.step);
+
+    const checkpoint_bench = addCppTest(b, "checkpoint_bench", "shared/checkpoint_bench.cpp", shared, target, optimize, &cxxflags);
+    const checkpoint_bench_cmd = checkpoint_bench.run();
+    if (b.args) |args| {
+        checkpoint_bench_cmd.addArgs(args);
+    }
+
+    const checkpoint_bench_step = b.step("bench-checkpoint", "Run the checkpointing benchmark");
+    checkpoint_bench_step.dependOn(&checkpoint_bench_cmd.step);
+
     // --- game graphical client ---
 
     const client = b.addExecutable(.{
@@ -63,25 +136,21 @@ pub fn build(b: *std.Build) void {
     });
 
     client.addCSourceFiles(&.{
+        "client/async_io.cpp",
+        "client/document_cache.cpp",
+        "client/hud.cpp",
         "client/main.cpp",
+        "client/profiler.cpp",
         "client/rml.cpp",
-    }, &cxxflags);
+        "client/sdf_font.cpp",
+        "client/sprite_batch.cpp",
+    }, &client_cxxflags);
 
     client.addIncludePath("ext/fmt/include");
     client.addCSourceFiles(&.{"ext/fmt/src/format.cc"}, &cxxflags);
 
-    client.linkLibrary(shared);
-
-    client.defineCMacro("PLATFORM_DESKTOP", null);
-    client.addIncludePath("ext/raylib/src");
-    client.linkLibrary(raylib);
-    client.addIncludePath("ext/raylib-cpp/include");
-
-    ext_build.addRmlUiOpts(client);
-    client.linkLibrary(rmlui);
-
-    client.addIncludePath("ext/physfs/src");
-    client.linkLibrary(physfs);
+    addClientLibraries(client, shared, raylib, rmlui, physfs);
+    addAsyncIO(client, io_uring);
 
     // This declares intent for the executable to be installed into the
     // standard location when the user invokes the "install" step (the default
@@ -111,6 +180,127 @@ pub fn build(b: *std.Build) void {
     const client_step = b.step("client", "Run the client");
     client_step.dependOn(&client_cmd.step);
 
+    // --- headless UI benchmark ---
+
+    const bench_ui = b.addExecutable(.{
+        .name = "bench-ui",
+        .target = target,
+        .optimize = optimize,
+    });
+
+    bench_ui.addCSourceFiles(&.{
+        "client/bench_ui.cpp",
+        "client/document_cache.cpp",
+        "client/hud.cpp",
+        "client/recording_render.cpp",
+        "client/rml.cpp",
+        "client/sdf_font.cpp",
+    }, &client_cxxflags);
+
+    addClientLibraries(bench_ui, shared, raylib, rmlui, physfs);
+
+    bench_ui.install();
+
+    const bench_ui_cmd = bench_ui.run();
+    bench_ui_cmd.step.dependOn(b.getInstallStep());
+    if (b.args) |args| {
+        bench_ui_cmd.addArgs(args);
+    }
+
+    const bench_ui_step = b.step("bench-ui", "Run the headless UI benchmark");
+    bench_ui_step.dependOn(&bench_ui_cmd.step);
+
+    // --- asset I/O benchmark ---
+
+    const bench_io = b.addExecutable(.{
+        .name = "bench-io",
+        .target = target,
+        .optimize = optimize,
+    });
+
+    bench_io.addCSourceFiles(&.{
+        "client/async_io.cpp",
+        "client/bench_io.cpp",
+        "client/rml.cpp",
+    }, &client_cxxflags);
+
+    addClientLibraries(bench_io, shared, raylib, rmlui, physfs);
+    addAsyncIO(bench_io, io_uring);
+
+    bench_io.install();
+
+    const bench_io_cmd = bench_io.run();
+    bench_io_cmd.step.dependOn(b.getInstallStep());
+    if (b.args) |args| {
+        bench_io_cmd.addArgs(args);
+    }
+
+    const bench_io_step = b.step("bench-io", "Run the asset I/O benchmark");
+    bench_io_step.dependOn(&bench_io_cmd.step);
+
+    // --- sprite rendering benchmark ---
+
+    const bench_sprites = b.addExecutable(.{
+        .name = "bench-sprites",
+        .target = target,
+        .optimize = optimize,
+    });
+
+    bench_sprites.addCSourceFiles(&.{
+        "client/bench_sprites.cpp",
+        "client/rml.cpp",
+        "client/sprite_batch.cpp",
+    }, &client_cxxflags);
+
+    addClientLibraries(bench_sprites, shared, raylib, rmlui, physfs);
+
+    bench_sprites.install();
+
+    const bench_sprites_cmd = bench_sprites.run();
+    bench_sprites_cmd.step.dependOn(b.getInstallStep());
+    if (b.args) |args| {
+        bench_sprites_cmd.addArgs(args);
+    }
+
+    const bench_sprites_step = b.step("bench-sprites", "Run the sprite rendering benchmark");
+    bench_sprites_step.dependOn(&bench_sprites_cmd.step);
+
+    // --- engine microbenchmarks ---
+
+    const bench = b.addExecutable(.{
+        .name = "bench",
+        .target = target,
+        .optimize = optimize,
+    });
+
+    bench.addCSourceFiles(&.{
+        "bench/bench.cpp",
+        "client/recording_render.cpp",
+        "client/rml.cpp",
+    }, &client_cxxflags);
+    bench.addCSourceFiles(&.{
+        "server/game_server.cpp",
+    }, &cxxflags);
+
+    bench.addIncludePath("client");
+    bench.addIncludePath("server");
+    addClientLibraries(bench, shared, raylib, rmlui, physfs);
+    bench.addIncludePath("ext/yojimbo");
+    bench.linkLibrary(yojimbo);
+
+    bench.install();
+
+    // CI runs `zig build bench -- --json bench.json --baseline <baseline.json>`,
+    // regressions past the tolerance fail the step.
+    const bench_cmd = bench.run();
+    bench_cmd.step.dependOn(b.getInstallStep());
+    if (b.args) |args| {
+        bench_cmd.addArgs(args);
+    }
+
+    const bench_step = b.step("bench", "Run the engine microbenchmarks");
+    bench_step.dependOn(&bench_cmd.step);
+
     // --- headless game server ---
 
     const server = b.addExecutable(.{
@@ -121,11 +311,14 @@ pub fn build(b: *std.Build) void {
     });
 
     server.addCSourceFiles(&.{
+        "server/game_server.cpp",
+        "server/server_admin.cpp",
         "server/server.cpp",
     }, &cxxflags);
 
     server.linkLibCpp();
 
+    server.addIncludePath("shared");
     server.linkLibrary(shared);
 
     server.addIncludePath("ext/yojimbo");
@@ -142,6 +335,37 @@ pub fn build(b: *std.Build) void {
     const server_step = b.step("server", "Run the server");
     server_step.dependOn(&server_cmd.step);
 
+    // --- headless test client, optionally behind a simulated network ---
+
+    const netclient = b.addExecutable(.{
+        .name = "netclient",
+        .target = target,
+        .optimize = optimize,
+    });
+
+    netclient.addCSourceFiles(&.{
+        "client/client.cpp",
+    }, &cxxflags);
+
+    netclient.linkLibCpp();
+
+    netclient.addIncludePath("shared");
+    netclient.linkLibrary(shared);
+
+    netclient.addIncludePath("ext/yojimbo");
+    netclient.linkLibrary(yojimbo);
+
+    netclient.install();
+
+    const netclient_cmd = netclient.run();
+    netclient_cmd.step.dependOn(b.getInstallStep());
+    if (b.args) |args| {
+        netclient_cmd.addArgs(args);
+    }
+
+    const netclient_step = b.step("netclient", "Run the headless test client");
+    netclient_step.dependOn(&netclient_cmd.step);
+
     const server_tests = b.addTest(.{
         .root_source_file = .{ .path = "server/main.zig" },
         .target = target,
@@ -156,6 +380,9 @@ pub fn build(b: *std.Build) void {
     const test_step = b.step("test", "Run unit tests");
     test_step.dependOn(&shared_tests.step);
     test_step.dependOn(&server_tests.step);
+    for (shared_cpp_tests) |t| {
+        test_step.dependOn(&t.run().step);
+    }
 
     // --- tooling ---
 
@@ -166,6 +393,62 @@ pub fn build(b: *std.Build) void {
     cdb_step.dependOn(&shared.step);
     cdb_step.dependOn(&client.step);
     cdb_step.dependOn(&server.step);
+    cdb_step.dependOn(&netclient.step);
+    cdb_step.dependOn(&bench_ui.step);
+    cdb_step.dependOn(&bench_io.step);
+    cdb_step.dependOn(&bench_sprites.step);
+    cdb_step.dependOn(&bench.step);
+}
+
+fn addClientLibraries(
+    exe: *std.Build.CompileStep,
+    shared: *std.Build.CompileStep,
+    raylib: *std.Build.CompileStep,
+    rmlui: *std.Build.CompileStep,
+    physfs: *std.Build.CompileStep,
+) void {
+    exe.addIncludePath("shared");
+    exe.linkLibrary(shared);
+
+    exe.defineCMacro("PLATFORM_DESKTOP", null);
+    exe.addIncludePath("ext/raylib/src");
+    exe.linkLibrary(raylib);
+    exe.addIncludePath("ext/raylib-cpp/include");
+
+    ext_build.addRmlUiOpts(exe);
+    exe.linkLibrary(rmlui);
+
+    exe.addIncludePath("ext/physfs/src");
+    exe.linkLibrary(physfs);
+}
+
+fn addAsyncIO(exe: *std.Build.CompileStep, io_uring: bool) void {
+    if (io_uring) {
+        exe.defineCMacro("MLGE_IO_URING", null);
+        exe.linkSystemLibrary("uring");
+    }
+}
+
+// C++ tests and benchmarks are plain executables returning non-zero on failure.
+fn addCppTest(
+    b: *std.Build,
+    name: []const u8,
+    source: []const u8,
+    shared: *std.Build.CompileStep,
+    target: std.zig.CrossTarget,
+    optimize: std.builtin.OptimizeMode,
+    cxxflags: []const []const u8,
+) *std.Build.CompileStep {
+    const t = b.addExecutable(.{
+        .name = name,
+        .target = target,
+        .optimize = optimize,
+    });
+    t.addCSourceFiles(&.{source}, cxxflags);
+    t.linkLibCpp();
+    t.addIncludePath("shared");
+    t.linkLibrary(shared);
+    return t;
 }
 
 fn makeCdb(b: *std.Build.Step) !void {
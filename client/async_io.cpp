@@ -0,0 +1,256 @@
+#include "async_io.h"
+
+#include "physfs.h"
+
+#ifdef MLGE_IO_URING
+#include <fcntl.h>
+#include <liburing.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct AsyncIO::Ring
+{
+	io_uring ring;
+	int		 in_flight	 = 0;
+	int		 unsubmitted = 0;  // queued since the last io_uring_submit()
+};
+#else
+struct AsyncIO::Ring
+{
+	int in_flight = 0;
+};
+#endif
+
+AsyncIO::AsyncIO(const Config &config)
+	: config{config},
+	  pending{0},
+	  stopping{false}
+{
+#ifdef MLGE_IO_URING
+	if (config.io_uring) {
+		ring = std::make_unique<Ring>();
+		if (io_uring_queue_init(config.queue_depth, &ring->ring, 0) < 0) ring.reset();	// no kernel support, or not allowed
+	}
+#endif
+}
+
+AsyncIO::~AsyncIO()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	submitted.notify_all();
+	for (auto &worker : workers) worker.join();
+
+#ifdef MLGE_IO_URING
+	if (ring) {
+		// The kernel may still write into request buffers.
+		while (ring->in_flight) ReapRing(true);
+		io_uring_queue_exit(&ring->ring);
+	}
+#endif
+}
+
+bool AsyncIO::IsUsingIoUring() const
+{
+	return ring != nullptr;
+}
+
+AsyncIO::ReadOperation AsyncIO::Read(const std::string &path)
+{
+	auto request	= std::make_shared<Request>();
+	request->path	= path;
+	request->ok		= false;
+	request->done	= false;
+	request->fd		= -1;
+	request->offset = 0;
+	pending++;
+
+	if (ring && SubmitRing(request)) return ReadOperation(request);
+
+	// Idle threads are not started until there is work for them.
+	if (workers.empty())
+		for (int i = 0; i < config.threads; i++) workers.emplace_back([this] { Work(); });
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queue.push_back(request);
+	}
+	submitted.notify_one();
+	return ReadOperation(request);
+}
+
+int AsyncIO::Poll(bool wait)
+{
+	ReapRing(false);
+
+	std::deque<std::shared_ptr<Request>> ready;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while (wait && pending > 0 && completions.empty()) {
+			if (ring && ring->in_flight) {
+				// Both backends may be in flight, wait on the ring in short slices.
+				lock.unlock();
+				ReapRing(true);
+				lock.lock();
+			}
+			else
+				completed.wait(lock, [this] { return !completions.empty(); });
+		}
+		ready.swap(completions);
+	}
+
+	// Resumed coroutines may start new reads, those complete in a later Poll().
+	for (auto &request : ready) {
+		request->done = true;
+		pending--;
+		if (auto waiter = request->waiter) {
+			request->waiter = nullptr;
+			waiter.resume();
+		}
+	}
+	return static_cast<int>(ready.size());
+}
+
+void AsyncIO::Complete(const std::shared_ptr<Request> &request)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		completions.push_back(request);
+	}
+	completed.notify_one();
+}
+
+// --- Thread pool ---------------------------------------------------------
+
+void AsyncIO::Work()
+{
+	while (true) {
+		std::shared_ptr<Request> request;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			submitted.wait(lock, [this] { return stopping || !queue.empty(); });
+			if (stopping) return;
+			request = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		if (PHYSFS_File *file = PHYSFS_openRead(request->path.c_str())) {
+			const PHYSFS_sint64 length = PHYSFS_fileLength(file);
+			if (length >= 0) {
+				request->bytes.resize(length);
+				request->ok = PHYSFS_readBytes(file, request->bytes.data(), length) == length;
+			}
+			PHYSFS_close(file);
+		}
+		Complete(request);
+	}
+}
+
+// --- io_uring ------------------------------------------------------------
+
+#ifdef MLGE_IO_URING
+
+bool AsyncIO::SubmitRing(const std::shared_ptr<Request> &request)
+{
+	// Only files in directory mounts have a path the kernel can open.
+	const char *mount = PHYSFS_getRealDir(request->path.c_str());
+	if (!mount) return false;
+
+	struct stat mount_stat;
+	if (stat(mount, &mount_stat) != 0 || !S_ISDIR(mount_stat.st_mode)) return false;
+
+	request->real_path = std::string(mount) + PHYSFS_getDirSeparator() + request->path;
+	request->fd		   = open(request->real_path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (request->fd < 0) return false;
+
+	struct stat	  file_stat;
+	io_uring_sqe *sqe = nullptr;
+	if (fstat(request->fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode)) {
+		request->bytes.resize(file_stat.st_size);
+		sqe = io_uring_get_sqe(&ring->ring);
+		if (!sqe) {
+			io_uring_submit(&ring->ring);
+			ring->unsubmitted = 0;
+			sqe				  = io_uring_get_sqe(&ring->ring);
+		}
+	}
+	if (!sqe) {
+		close(request->fd);
+		request->fd = -1;
+		request->bytes.clear();
+		return false;
+	}
+
+	// Submitted in batches from ReapRing(), one system call for a burst of reads.
+	io_uring_prep_read(sqe, request->fd, request->bytes.data(), request->bytes.size(), 0);
+	io_uring_sqe_set_data(sqe, new std::shared_ptr<Request>(request));
+	ring->in_flight++;
+	ring->unsubmitted++;
+	return true;
+}
+
+int AsyncIO::ReapRing(bool wait)
+{
+	if (!ring || !ring->in_flight) return 0;
+
+	if (ring->unsubmitted) {
+		io_uring_submit(&ring->ring);
+		ring->unsubmitted = 0;
+	}
+
+	int				  reaped = 0;
+	io_uring_cqe	 *cqe	 = nullptr;
+	__kernel_timespec timeout{0, 1000000};	// 1 ms
+	if (wait && io_uring_wait_cqe_timeout(&ring->ring, &cqe, &timeout) != 0) return 0;
+
+	while (io_uring_peek_cqe(&ring->ring, &cqe) == 0) {
+		auto	 *holder  = static_cast<std::shared_ptr<Request> *>(io_uring_cqe_get_data(cqe));
+		auto	  request = *holder;
+		const int result  = cqe->res;
+		io_uring_cqe_seen(&ring->ring, cqe);
+		ring->in_flight--;
+		delete holder;
+		reaped++;
+
+		if (result > 0) request->offset += result;
+
+		// Short reads continue where they stopped, errors and EOF end the read.
+		if (result > 0 && request->offset < request->bytes.size()) {
+			if (io_uring_sqe *sqe = io_uring_get_sqe(&ring->ring)) {
+				io_uring_prep_read(sqe, request->fd, request->bytes.data() + request->offset,
+								   request->bytes.size() - request->offset, request->offset);
+				io_uring_sqe_set_data(sqe, new std::shared_ptr<Request>(request));
+				ring->in_flight++;
+				ring->unsubmitted++;
+				continue;
+			}
+		}
+
+		request->ok = request->offset == request->bytes.size();
+		close(request->fd);
+		request->fd = -1;
+		Complete(request);
+	}
+
+	if (ring->unsubmitted) {
+		io_uring_submit(&ring->ring);
+		ring->unsubmitted = 0;
+	}
+	return reaped;
+}
+
+#else
+
+bool AsyncIO::SubmitRing(const std::shared_ptr<Request> &)
+{
+	return false;
+}
+
+int AsyncIO::ReapRing(bool)
+{
+	return 0;
+}
+
+#endif
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous whole-file reads through PhysFS for C++20 coroutines.
+//
+// Read() starts the read immediately and returns an awaitable, so starting
+// several reads before awaiting any of them overlaps their latency:
+//
+//     AsyncTask load_level(AsyncIO &io)
+//     {
+//         auto map   = io.Read("data/level.map");
+//         auto tiles = io.Read("assets/tiles.png");
+//         FileData map_data = co_await map;
+//         FileData tile_data = co_await tiles;
+//         ...
+//     }
+//
+// Files in directory mounts are read with io_uring when built with
+// MLGE_IO_URING and the kernel allows it; archives, and everything without
+// io_uring, go to a small thread pool, started by the first read that needs
+// it. Coroutines are only ever resumed from Poll(), called once per frame on
+// the main thread, so they can use raylib and RmlUi freely.
+
+struct FileData
+{
+	std::vector<unsigned char> bytes;
+	bool					   ok;
+};
+
+class AsyncIO
+{
+	struct Request
+	{
+		std::string				   path;
+		std::string				   real_path;  // set for io_uring reads
+		std::vector<unsigned char> bytes;
+		bool					   ok;
+		bool					   done;
+		std::coroutine_handle<>	   waiter;
+		int						   fd;
+		size_t					   offset;
+	};
+
+   public:
+	struct Config
+	{
+		int	 threads	 = 4;	  // started on the first thread pool read
+		bool io_uring	 = true;  // when compiled in
+		int	 queue_depth = 256;
+	};
+
+	class ReadOperation
+	{
+		std::shared_ptr<Request> request;
+
+	   public:
+		explicit ReadOperation(std::shared_ptr<Request> request) : request{std::move(request)} {}
+		ReadOperation(ReadOperation &&) = default;
+		~ReadOperation()
+		{
+			// The awaiting coroutine is going away, do not resume it.
+			if (request) request->waiter = nullptr;
+		}
+
+		bool	 await_ready() const { return request->done; }
+		void	 await_suspend(std::coroutine_handle<> waiter) { request->waiter = waiter; }
+		FileData await_resume() { return {std::move(request->bytes), request->ok}; }
+	};
+
+	AsyncIO() : AsyncIO(Config{}) {}
+	explicit AsyncIO(const Config &config);
+	~AsyncIO();
+
+	AsyncIO(const AsyncIO &)			= delete;
+	AsyncIO &operator=(const AsyncIO &) = delete;
+
+	ReadOperation Read(const std::string &path);
+
+	// Resumes coroutines whose reads completed. With `wait`, blocks until at
+	// least one read completes, unless none is in flight.
+	int Poll(bool wait = false);
+
+	int	 GetPending() const { return pending; }
+	bool IsUsingIoUring() const;
+
+   private:
+	Config							   config;
+	int								   pending;
+	std::vector<std::thread>		   workers;
+	std::mutex						   mutex;
+	std::condition_variable			   submitted;
+	std::condition_variable			   completed;
+	std::deque<std::shared_ptr<Request>> queue;		  // for the workers
+	std::deque<std::shared_ptr<Request>> completions;  // from the workers
+	bool							   stopping;
+
+	struct Ring;
+	std::unique_ptr<Ring> ring;
+
+	void Work();
+	void Complete(const std::shared_ptr<Request> &request);
+	bool SubmitRing(const std::shared_ptr<Request> &request);
+	int	 ReapRing(bool wait);
+};
+
+// Coroutine started on creation, finished ones can be polled with IsDone().
+// Destroying the task destroys a suspended coroutine, and with it its
+// interest in pending reads.
+class AsyncTask
+{
+   public:
+	struct promise_type
+	{
+		AsyncTask			get_return_object() { return AsyncTask{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+		std::suspend_never	initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void				return_void() {}
+		void				unhandled_exception() { std::terminate(); }
+	};
+
+	AsyncTask() = default;
+	AsyncTask(AsyncTask &&other) noexcept : handle{other.handle} { other.handle = nullptr; }
+	AsyncTask &operator=(AsyncTask &&other) noexcept
+	{
+		if (this != &other) {
+			if (handle) handle.destroy();
+			handle		 = other.handle;
+			other.handle = nullptr;
+		}
+		return *this;
+	}
+	~AsyncTask()
+	{
+		if (handle) handle.destroy();
+	}
+
+	bool IsDone() const { return !handle || handle.done(); }
+
+   private:
+	explicit AsyncTask(std::coroutine_handle<promise_type> handle) : handle{handle} {}
+
+	std::coroutine_handle<promise_type> handle;
+};
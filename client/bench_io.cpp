@@ -0,0 +1,101 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "async_io.h"
+#include "bench.h"
+#include "physfs.h"
+#include "rml.h"
+
+// Load time of many small assets: serial load_file_data() against AsyncIO
+// coroutines on the thread pool and, when built with -Dio-uring, io_uring.
+//
+//     bench-io [files] [bytes] [iterations]
+//
+// The files are written to the write directory first, a directory mount, so
+// they are served from the page cache; this measures per-file overhead and
+// overlap rather than disk latency. They are deleted again before exiting.
+
+static AsyncTask load_all(AsyncIO &io, const std::vector<std::string> &paths, size_t &bytes, int &failed)
+{
+	std::vector<AsyncIO::ReadOperation> reads;
+	reads.reserve(paths.size());
+	for (const auto &path : paths) reads.push_back(io.Read(path));
+
+	for (auto &read : reads) {
+		FileData data = co_await read;
+		bytes += data.bytes.size();
+		failed += !data.ok;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const int files		 = argc > 1 ? atoi(argv[1]) : 500;
+	const int file_bytes = argc > 2 ? atoi(argv[2]) : 4096;
+	const int iterations = argc > 3 ? atoi(argv[3]) : 20;
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	GameFileInterface file_interface(argv);
+	if (!file_interface.set_write_dir("mlge", "mlge")) {
+		fprintf(stderr, "error: no write directory\n");
+		return 1;
+	}
+
+	std::vector<std::string> paths;
+	auto					 remove_files = [&] {
+		for (const auto &path : paths) PHYSFS_delete(path.c_str());
+		PHYSFS_delete("cache/bench/io");
+		PHYSFS_delete("cache/bench");
+	};
+
+	std::vector<unsigned char> contents(file_bytes);
+	for (int i = 0; i < files; i++) {
+		for (int j = 0; j < file_bytes; j++) contents[j] = static_cast<unsigned char>(i * 31 + j);
+		paths.push_back(Rml::CreateString(64, "cache/bench/io/%04d.bin", i));
+		if (!save_file_data(paths.back().c_str(), contents.data(), contents.size())) {
+			fprintf(stderr, "error: cannot write %s\n", paths.back().c_str());
+			remove_files();
+			return 1;
+		}
+	}
+
+	Bench  bench("bench-io");
+	size_t expected = static_cast<size_t>(files) * file_bytes;
+	int	   failed	= 0;
+
+	bench.Run("serial load_file_data", iterations, [&] {
+		size_t bytes = 0;
+		for (const auto &path : paths) {
+			unsigned int   read = 0;
+			unsigned char *data = load_file_data(path.c_str(), &read);
+			bytes += read;
+			UnloadFileData(data);
+		}
+		failed += bytes != expected;
+	});
+
+	auto run_async = [&](const char *name, bool io_uring) {
+		AsyncIO::Config config;
+		config.io_uring = io_uring;
+		AsyncIO io(config);
+		if (io_uring && !io.IsUsingIoUring()) return;
+
+		bench.Run(name, iterations, [&] {
+			size_t	  bytes = 0;
+			AsyncTask task	= load_all(io, paths, bytes, failed);
+			while (!task.IsDone()) io.Poll(true);
+			failed += bytes != expected;
+		});
+	};
+	run_async("async, thread pool", false);
+	run_async("async, io_uring", true);
+	remove_files();
+
+	bench.Counter("files", files);
+	bench.Counter("bytes per file", file_bytes);
+	bench.Counter("failed", failed);
+	bench.Print();
+
+	return failed ? 1 : 0;
+}
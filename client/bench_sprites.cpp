@@ -0,0 +1,185 @@
+#include <cstdlib>
+#include <cstring>
+
+#include "bench.h"
+#include "rml.h"
+#include "sprite_batch.h"
+
+// Sprite rendering for a large world: moving, culling through the spatial
+// grid, sorting and packing, and drawing through SpriteBatch against one
+// DrawTexturePro() per sprite.
+//
+//     bench-sprites [--sprites N] [--frames N] [--world SIZE] [--headless]
+//
+// Sprites alternate between two textures over four layers, the worst case
+// for draw order. Draws are measured twice, for the 1280x720 camera view and
+// zoomed out over the whole world. Frames are timed to the end of
+// EndDrawing(), in a hidden window without vsync. --headless runs the CPU
+// cases only.
+
+struct Body
+{
+	int		id;
+	Vector2 velocity;
+};
+
+static float random_float(float range)
+{
+	return static_cast<float>(rand()) / RAND_MAX * range;
+}
+
+int main(int argc, char *argv[])
+{
+	int	  sprites  = 50000;
+	int	  frames   = 300;
+	float world	   = 16384.0f;
+	bool  headless = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--sprites") && i + 1 < argc)
+			sprites = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--world") && i + 1 < argc)
+			world = static_cast<float>(atof(argv[++i]));
+		else if (!strcmp(argv[i], "--headless"))
+			headless = true;
+	}
+
+	const int screen_width = 1280, screen_height = 720;
+
+	Texture2D textures[2] = {{1, 512, 512, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8},
+							 {2, 64, 64, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8}};
+	if (!headless) {
+		SetTraceLogLevel(LOG_WARNING);
+		SetConfigFlags(FLAG_WINDOW_HIDDEN);
+		InitWindow(screen_width, screen_height, "bench-sprites");
+		SetTargetFPS(0);
+
+		GameFileInterface file_interface(argv);
+		file_interface.mount("resources");
+		SetLoadFileDataCallback(load_file_data);
+
+		textures[0]	 = LoadTexture("assets/invader.tga");
+		Image border = GenImageChecked(64, 64, 8, 8, WHITE, GRAY);
+		textures[1]	 = LoadTextureFromImage(border);
+		UnloadImage(border);
+	}
+
+	srand(1);
+	SpriteSet		  set;
+	std::vector<Body> bodies;
+	for (int i = 0; i < sprites; i++) {
+		const float size = 16.0f + random_float(32.0f);
+		Sprite		sprite;
+		sprite.texture = textures[i / 4 % 2];
+		sprite.source  = i / 4 % 2 ? Rectangle{0, 0, 64, 64} : Rectangle{0, 0, 133, 140};
+		sprite.dest	   = {random_float(world - size), random_float(world - size), size, size};
+		sprite.tint	   = {static_cast<unsigned char>(128 + rand() % 128), static_cast<unsigned char>(128 + rand() % 128),
+						  255, 255};
+		sprite.layer   = i % 4;
+		bodies.push_back({set.Add(sprite), {random_float(200.0f) - 100.0f, random_float(200.0f) - 100.0f}});
+	}
+
+	Camera2D camera{};
+	camera.offset = {screen_width / 2.0f, screen_height / 2.0f};
+	camera.target = {world / 2.0f, world / 2.0f};
+	camera.zoom	  = 1.0f;
+
+	Camera2D overview = camera;
+	overview.zoom	  = screen_height / world;
+
+	const float dt = 1.0f / 60.0f;
+	auto move = [&] {
+		for (auto &body : bodies) {
+			Rectangle dest = set.Get(body.id).dest;
+			dest.x += body.velocity.x * dt;
+			dest.y += body.velocity.y * dt;
+			if (dest.x < 0 || dest.x + dest.width > world) body.velocity.x = -body.velocity.x;
+			if (dest.y < 0 || dest.y + dest.height > world) body.velocity.y = -body.velocity.y;
+			set.Move(body.id, dest);
+		}
+	};
+
+	Bench		bench("bench-sprites");
+	SpriteBatch batch;
+	Rectangle	view	= camera_view(camera, screen_width, screen_height);
+	int			visible = 0;
+
+	bench.Run("move, grid update", frames, move);
+
+	bench.Run("cull, grid query", frames, [&] {
+		batch.Begin();
+		visible = set.Draw(batch, view);
+	});
+
+	int scanned = 0;
+	bench.Run("cull, scan", frames, [&] {
+		scanned = 0;
+		for (const auto &body : bodies) scanned += CheckCollisionRecs(set.Get(body.id).dest, view);
+	});
+
+	bench.Run("sort and pack, view", frames, [&] {
+		batch.Begin();
+		set.Draw(batch, view);
+		batch.Prepare();
+	});
+	const int view_runs = batch.GetRuns();
+
+	const Rectangle world_view = {0, 0, world, world};
+	bench.Run("sort and pack, world", frames, [&] {
+		batch.Begin();
+		set.Draw(batch, world_view);
+		batch.Prepare();
+	});
+	const int world_runs = batch.GetRuns();
+
+	bench.Counter("sprites", sprites);
+	bench.Counter("visible in view", visible);
+	bench.Counter("visible in view, scan", scanned);
+	bench.Counter("runs, view", view_runs);
+	bench.Counter("runs, world", world_runs);
+
+	if (!headless) {
+		auto draw_frames = [&](const char *name, const Camera2D &frame_camera, bool batched) {
+			const Rectangle frame_view = camera_view(frame_camera, screen_width, screen_height);
+			bench.Run(name, frames, [&] {
+				BeginDrawing();
+				ClearBackground(BLACK);
+				BeginMode2D(frame_camera);
+				if (batched) {
+					batch.Begin();
+					set.Draw(batch, frame_view);
+					batch.End();
+				}
+				else {
+					// Layer by layer in entity order, what drawing entities one by one gives.
+					for (int layer = 0; layer < 4; layer++)
+						for (int i = layer; i < sprites; i += 4) {
+							const Sprite &sprite = set.Get(bodies[i].id);
+							if (CheckCollisionRecs(sprite.dest, frame_view))
+								DrawTexturePro(sprite.texture, sprite.source, sprite.dest, {0, 0}, 0.0f, sprite.tint);
+						}
+				}
+				EndMode2D();
+				EndDrawing();
+			});
+		};
+
+		draw_frames("draw view, per sprite", camera, false);
+		draw_frames("draw view, batch", camera, true);
+		bench.Counter("draw calls, view", batch.GetDrawCalls());
+		draw_frames("draw world, per sprite", overview, false);
+		draw_frames("draw world, batch", overview, true);
+		bench.Counter("draw calls, world", batch.GetDrawCalls());
+		bench.Counter("instanced", batch.IsInstanced());
+	}
+
+	bench.Print();
+
+	if (!headless) {
+		UnloadTexture(textures[0]);
+		UnloadTexture(textures[1]);
+		CloseWindow();
+	}
+	return 0;
+}
@@ -0,0 +1,369 @@
+#include <RmlUi/Core.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+
+#include "bench.h"
+#include "document_cache.h"
+#include "hud.h"
+#include "physfs.h"
+#include "recording_render.h"
+#include "rml.h"
+#include "sdf_font.h"
+
+// Headless UI benchmark: runs RmlUi documents against the recording render
+// interface with scripted input, and reports per-frame update/render cost.
+//
+//     bench-ui [--frames N] [--size WxH] [--script data/bench-ui.txt] [--hud N] [--startup N] [--list N]
+//              [document.rml ...]
+//
+// --hud N additionally compares a HUD of N live values updated through the
+// GameHud data model against per-frame SetInnerRML() calls.
+//
+// --list N adds a scrolling list of N rows, clipped by its box, to measure the
+// draws the render interface culls and the scissor flushes it avoids.
+//
+// --startup N loads the documents, and a generated large document, N times
+// each uncached, through a cold DocumentCache and through a warm one.
+//
+// Script lines are `<frame> <command> [args]`, the script loops:
+//
+//     move <x> <y> | down <button> | up <button> | wheel <delta> | key <raylib key> | text <string>
+
+// Deterministic clock, advanced by exactly one 60 Hz frame per frame.
+class HeadlessSystemInterface : public GameSystemInterface
+{
+	Rml::String clipboard;
+
+   public:
+	double time = 0.0;
+
+	double GetElapsedTime() override { return time; }
+	void   SetMouseCursor(const Rml::String &) override {}
+	void   SetClipboardText(const Rml::String &text) override { clipboard = text; }
+	void   GetClipboardText(Rml::String &text) override { text = clipboard; }
+};
+
+struct ScriptEvent
+{
+	int			frame;
+	Rml::String command;
+	int			x, y;
+	Rml::String text;
+};
+
+static bool load_script(const Rml::String &path, std::vector<ScriptEvent> &events)
+{
+	Rml::FileInterface *file_interface = Rml::GetFileInterface();
+	Rml::FileHandle		file		   = file_interface->Open(path);
+	if (!file) return false;
+
+	Rml::String source(file_interface->Length(file), '\0');
+	file_interface->Read(&source[0], source.size(), file);
+	file_interface->Close(file);
+
+	std::istringstream lines(source);
+	std::string		   line;
+	while (std::getline(lines, line)) {
+		if (line.empty() || line[0] == '#') continue;
+
+		std::istringstream fields(line);
+		ScriptEvent		   event{};
+		if (!(fields >> event.frame >> event.command)) continue;
+		if (event.command == "text")
+			fields >> event.text;
+		else
+			fields >> event.x >> event.y;
+		events.push_back(event);
+	}
+	return !events.empty();
+}
+
+// Sweeps the pointer across the context, clicking and scrolling on the way.
+static std::vector<ScriptEvent> default_script(int width, int height)
+{
+	std::vector<ScriptEvent> events;
+	for (int frame = 0; frame < 120; frame++) {
+		events.push_back({frame, "move", width * frame / 120, height * frame / 120, ""});
+		if (frame % 30 == 10) events.push_back({frame, "down", 0, 0, ""});
+		if (frame % 30 == 12) events.push_back({frame, "up", 0, 0, ""});
+		if (frame % 40 == 20) events.push_back({frame, "wheel", 1, 0, ""});
+	}
+	return events;
+}
+
+static void apply(Rml::Context *context, const ScriptEvent &event)
+{
+	if (event.command == "move")
+		context->ProcessMouseMove(event.x, event.y, 0);
+	else if (event.command == "down")
+		context->ProcessMouseButtonDown(event.x, 0);
+	else if (event.command == "up")
+		context->ProcessMouseButtonUp(event.x, 0);
+	else if (event.command == "wheel")
+		context->ProcessMouseWheel(static_cast<float>(event.x), 0);
+	else if (event.command == "key")
+		context->ProcessKeyDown(raylib_key_to_identifier(static_cast<KeyboardKey>(event.x)), 0);
+	else if (event.command == "text")
+		context->ProcessTextInput(event.text);
+}
+
+static Rml::String hud_document(int values, bool bound)
+{
+	Rml::String rml = "<rml><head><style>"
+					  "body { font-family: Press Start 2P; font-size: 8dp; width: 100%; height: 100%; }"
+					  "div { display: inline-block; width: 180dp; }"
+					  "</style></head>";
+	rml += bound ? "<body data-model=\"hud_bench\">" : "<body>";
+	for (int i = 0; i < values; i++) {
+		const Rml::String name = "v" + Rml::ToString(i);
+		if (bound)
+			rml += "<div>" + name + ": {{" + name + "}}</div>";
+		else
+			rml += "<div id=\"" + name + "\">" + name + ": 0</div>";
+	}
+	return rml + "</body></rml>";
+}
+
+// Fills the context, so the scripted pointer scrolls it.
+static Rml::String list_document(int rows)
+{
+	Rml::String rml = "<rml><head><style>"
+					  "body { font-family: Press Start 2P; font-size: 8dp; width: 100%; height: 100%; overflow-y: auto; }"
+					  "div { display: block; height: 16dp; border-bottom: 1dp #ffffff40; }"
+					  "</style></head><body>";
+	for (int i = 0; i < rows; i++) rml += Rml::CreateString(64, "<div>row %d</div>", i);
+	return rml + "</body></rml>";
+}
+
+// Each frame changes every `stride`-th value.
+static void run_hud_bench(Bench &bench, Rml::Context *context, RecordingRenderInterface &render_interface,
+						  int values, int frames)
+{
+	GameHud					   hud("hud_bench");
+	std::vector<GameHud::Field> fields;
+	for (int i = 0; i < values; i++) fields.push_back(hud.Add("v" + Rml::ToString(i), 0));
+	hud.Initialise(context);
+
+	for (bool bound : {true, false}) {
+		Rml::ElementDocument *document = context->LoadDocumentFromMemory(hud_document(values, bound));
+		document->Show();
+
+		std::vector<Rml::Element *> elements;
+		if (!bound)
+			for (int i = 0; i < values; i++) elements.push_back(document->GetElementById("v" + Rml::ToString(i)));
+
+		for (int stride : {1, 10}) {
+			std::vector<double> frame_ms;
+			for (int frame = 0; frame < frames; frame++) {
+				auto start = Bench::Clock::now();
+
+				for (int i = frame % stride; i < values; i += stride) {
+					const int value = frame * values + i;
+					if (bound)
+						hud.Set(fields[i], value);
+					else
+						elements[i]->SetInnerRML("v" + Rml::ToString(i) + ": " + Rml::ToString(value));
+				}
+				hud.Sync();
+
+				context->Update();
+				render_interface.BeginFrame();
+				context->Render();
+				render_interface.EndFrame();
+
+				frame_ms.push_back(std::chrono::duration<double, std::milli>(Bench::Clock::now() - start).count());
+			}
+
+			bench.Record(Rml::CreateString(64, "hud %s, %d%% changing", bound ? "data model" : "SetInnerRML", 100 / stride),
+						 frame_ms);
+		}
+
+		document->Close();
+		context->Update();
+	}
+}
+
+// Many rules and elements, written to the write directory next to its style sheet.
+static bool write_large_document(const Rml::String &path)
+{
+	Rml::String rcss, rml = "<rml><head><link type=\"text/css\" href=\"large.rcss\"/></head><body>";
+	for (int i = 0; i < 500; i++) {
+		rcss += Rml::CreateString(256,
+								  "/* panel %d */\n.panel-%d\n{\n\tdisplay: inline-block;\n\twidth: %ddp;\n\tmargin: %ddp;\n}\n"
+								  ".panel-%d:hover > span\n{\n\tcolor: #%06x;\n}\n\n",
+								  i, i, 40 + i % 60, i % 8, i, (i * 2654435761u) & 0xffffff);
+		rml += Rml::CreateString(128, "\n\t<!-- panel %d -->\n\t<div class=\"panel-%d\"><span>%d</span></div>", i, i, i);
+	}
+	rml += "</body></rml>";
+
+	const Rml::String base = path.substr(0, path.rfind('/') + 1);
+	return save_file_data((base + "large.rcss").c_str(), &rcss[0], rcss.size())
+		&& save_file_data(path.c_str(), &rml[0], rml.size());
+}
+
+static void run_startup_bench(Bench &bench, Rml::Context *context, std::vector<Rml::String> documents, int iterations)
+{
+	const Rml::String large = "cache/bench/large.rml";
+	if (write_large_document(large))
+		documents.push_back(large);
+	else
+		fprintf(stderr, "warning: no write directory, startup bench runs uncached only\n");
+
+	DocumentCache cache("cache/bench/documents");
+
+	for (const auto &path : documents) {
+		// Forget the style sheets and templates RmlUi keeps for the process
+		// lifetime, so every load starts as a fresh launch would.
+		auto load = [&](const char *mode, std::function<Rml::ElementDocument *()> loader) {
+			std::vector<double> load_ms;
+			for (int i = 0; i < iterations; i++) {
+				if (!strcmp(mode, "cold")) cache.Invalidate(path);
+				Rml::Factory::ClearStyleSheetCache();
+				Rml::Factory::ClearTemplateCache();
+
+				auto				  start	   = Bench::Clock::now();
+				Rml::ElementDocument *document = loader();
+				load_ms.push_back(std::chrono::duration<double, std::milli>(Bench::Clock::now() - start).count());
+
+				if (document) document->Close();
+				context->Update();
+			}
+			bench.Record(Rml::CreateString(256, "startup %s, %s", mode, path.c_str()), load_ms);
+		};
+
+		load("uncached", [&] { return context->LoadDocument(path); });
+		load("cold", [&] { return cache.LoadDocument(context, path); });
+		load("warm", [&] { return cache.LoadDocument(context, path); });
+	}
+
+	bench.Counter("document cache hits", cache.GetStats().hits);
+	bench.Counter("document cache misses", cache.GetStats().misses);
+
+	// Leave nothing behind in the write directory.
+	for (const auto &path : documents) cache.Invalidate(path);
+	PHYSFS_delete(large.c_str());
+	PHYSFS_delete("cache/bench/large.rcss");
+	PHYSFS_delete("cache/bench/documents");
+	PHYSFS_delete("cache/bench");
+}
+
+int main(int argc, char *argv[])
+{
+	int						 frames = 600, width = 800, height = 480, hud_values = 0, startup_iterations = 0, list_rows = 0;
+	Rml::String				 script_path;
+	std::vector<Rml::String> documents;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+			frames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--size") && i + 1 < argc)
+			sscanf(argv[++i], "%dx%d", &width, &height);
+		else if (!strcmp(argv[i], "--script") && i + 1 < argc)
+			script_path = argv[++i];
+		else if (!strcmp(argv[i], "--hud") && i + 1 < argc)
+			hud_values = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--startup") && i + 1 < argc)
+			startup_iterations = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--list") && i + 1 < argc)
+			list_rows = atoi(argv[++i]);
+		else
+			documents.push_back(argv[i]);
+	}
+	if (documents.empty()) documents.push_back("data/tutorial.rml");
+
+	SetTraceLogLevel(LOG_WARNING);
+
+	HeadlessSystemInterface system_interface;
+	Rml::SetSystemInterface(&system_interface);
+	RecordingRenderInterface render_interface;
+	render_interface.SetViewport(width, height);
+	Rml::SetRenderInterface(&render_interface);
+	GameFileInterface file_interface(argv);
+	Rml::SetFileInterface(&file_interface);
+	SetLoadFileDataCallback(load_file_data);
+	SetSaveFileDataCallback(save_file_data);
+	SdfFontEngine font_engine;
+	Rml::SetFontEngineInterface(&font_engine);
+
+	file_interface.mount("resources");
+	if (!file_interface.set_write_dir("mlge", "mlge")) TraceLog(LOG_WARNING, "FILEIO: No write directory, caches disabled");
+
+	Rml::Initialise();
+
+	Rml::Context *context = Rml::CreateContext("bench", Rml::Vector2i(width, height));
+	Rml::LoadFontFace("assets/PressStart2P-vaV7.ttf");
+
+	GameHud hud;
+	hud.Add("score", 0);
+	hud.Initialise(context);
+
+	std::vector<ScriptEvent> script;
+	if (script_path.empty())
+		script = default_script(width, height);
+	else if (!load_script(script_path, script)) {
+		fprintf(stderr, "error: cannot load script %s\n", script_path.c_str());
+		return 1;
+	}
+	const int period = script.back().frame + 1;
+
+	Bench bench("bench-ui");
+
+	auto load_start = Bench::Clock::now();
+	for (const auto &path : documents) {
+		Rml::ElementDocument *document = context->LoadDocument(path);
+		if (!document) {
+			fprintf(stderr, "error: cannot load document %s\n", path.c_str());
+			return 1;
+		}
+		document->Show();
+	}
+	if (list_rows > 0) context->LoadDocumentFromMemory(list_document(list_rows))->Show();
+	bench.Record("load documents", {std::chrono::duration<double, std::milli>(Bench::Clock::now() - load_start).count()});
+
+	std::vector<double> update_ms, render_ms;
+	update_ms.reserve(frames);
+	render_ms.reserve(frames);
+
+	for (int frame = 0; frame < frames; frame++) {
+		system_interface.time = frame / 60.0;
+		for (const auto &event : script)
+			if (event.frame == frame % period) apply(context, event);
+
+		auto start = Bench::Clock::now();
+		context->Update();
+		auto updated = Bench::Clock::now();
+		render_interface.BeginFrame();
+		context->Render();
+		render_interface.EndFrame();
+		auto rendered = Bench::Clock::now();
+
+		update_ms.push_back(std::chrono::duration<double, std::milli>(updated - start).count());
+		render_ms.push_back(std::chrono::duration<double, std::milli>(rendered - updated).count());
+	}
+
+	bench.Record("update", update_ms);
+	bench.Record("render", render_ms);
+
+	const RenderStats total = render_interface.GetTotalStats();
+
+	if (hud_values > 0) run_hud_bench(bench, context, render_interface, hud_values, frames);
+	if (startup_iterations > 0) run_startup_bench(bench, context, documents, startup_iterations);
+
+	bench.Counter("geometry calls / frame", double(total.geometry_calls) / frames);
+	bench.Counter("vertices / frame", double(total.vertices) / frames);
+	bench.Counter("texture binds / frame", double(total.texture_binds) / frames);
+	bench.Counter("culled calls / frame", double(total.culled_calls) / frames);
+	bench.Counter("scissored calls / frame", double(total.scissored_calls) / frames);
+	bench.Counter("scissor changes / frame", double(total.scissor_changes) / frames);
+	bench.Counter("textures loaded", total.textures_loaded);
+	bench.Counter("textures generated", total.textures_generated);
+	bench.Counter("texture KiB", total.texture_bytes / 1024.0);
+	bench.Print();
+
+	Rml::Shutdown();
+
+	return 0;
+}
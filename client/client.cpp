@@ -26,10 +26,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <inttypes.h>
 #include <time.h>
 #include <signal.h>
 #include "shared.h"
+#include "net_relay.h"
 
 using namespace yojimbo;
 
@@ -56,21 +58,63 @@ int ClientMain( int argc, char * argv[] )
 
     Address serverAddress( "127.0.0.1", ServerPort );
 
-    if ( argc == 2 )
+    // client [--via relay address] [--net-... conditions] [server address]
+    //
+    // --net-... options (see net_sim.h) route the connection through a
+    // simulated network in this process, --via through a relay hosted
+    // elsewhere, like the server's own.
+    NetSimConfig conditions;
+    Address viaAddress;
+
+    for ( int i = 1; i < argc; ++i )
     {
-        Address commandLineAddress( argv[1] );
-        if ( commandLineAddress.IsValid() )
-        {
-            if ( commandLineAddress.GetPort() == 0 )
-                commandLineAddress.SetPort( ServerPort );
+        if ( net_sim_parse_arg( conditions, argc, argv, i ) )
+            continue;
+
+        const bool via = !strcmp( argv[i], "--via" ) && i + 1 < argc;
+        Address commandLineAddress( via ? argv[++i] : argv[i] );
+        if ( !commandLineAddress.IsValid() )
+            continue;
+
+        if ( commandLineAddress.GetPort() == 0 )
+            commandLineAddress.SetPort( ServerPort );
+        if ( via )
+            viaAddress = commandLineAddress;
+        else
             serverAddress = commandLineAddress;
+    }
+
+    NetRelay relay( NetRelay::Config::Symmetric( conditions ) );
+
+    if ( conditions.IsActive() )
+    {
+        char host[64];
+        const uint8_t * ip = serverAddress.GetAddress4();
+        snprintf( host, sizeof( host ), "%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3] );
+        if ( serverAddress.GetType() != ADDRESS_IPV4 || !relay.Open( 0, host, serverAddress.GetPort() ) )
+        {
+            printf( "error: cannot open the network simulator relay\n" );
+            return 1;
         }
+        viaAddress = Address( "127.0.0.1", relay.GetPort() );
+        printf( "simulating %.0f ms latency, %.0f ms jitter, %.1f%% loss each way, seed %" PRIu64 "\n",
+            conditions.latency_ms, conditions.jitter_ms, conditions.loss * 100.0, conditions.seed );
     }
 
     uint8_t privateKey[KeyBytes];
     memset( privateKey, 0, KeyBytes );
 
-    client.InsecureConnect( privateKey, clientId, serverAddress );
+    // Through a relay, the token lists the relay to connect to and the
+    // server, which only accepts tokens listing its own address.
+    if ( viaAddress.IsValid() )
+    {
+        Address serverAddresses[] = { viaAddress, serverAddress };
+        client.InsecureConnect( privateKey, clientId, serverAddresses, 2 );
+    }
+    else
+    {
+        client.InsecureConnect( privateKey, clientId, serverAddress );
+    }
 
     char addressString[256];
     client.GetAddress().ToString( addressString, sizeof( addressString ) );
@@ -84,6 +128,8 @@ int ClientMain( int argc, char * argv[] )
     {
         client.SendPackets();
 
+        relay.Update( time );
+
         client.ReceivePackets();
 
         if ( client.IsDisconnected() )
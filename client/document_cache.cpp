@@ -0,0 +1,232 @@
+#include "document_cache.h"
+
+#include "physfs.h"
+#include "rml.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace Rml;
+
+// Entry manifest, "<entry>.dep":
+//
+//     mlge-document <version> <document hash>
+//     <size> <content hash> <source path>
+//     ...
+static const int CacheVersion = 2;
+
+static uint64_t fnv1a(const String &string)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (unsigned char c : string) hash = (hash ^ c) * 0x100000001b3ull;
+	return hash;
+}
+
+static bool read_file(const String &path, String &contents)
+{
+	PHYSFS_File *file = PHYSFS_openRead(path.c_str());
+	if (!file) return false;
+
+	const PHYSFS_sint64 length = PHYSFS_fileLength(file);
+	contents.resize(length > 0 ? length : 0);
+	const bool ok = length >= 0 && PHYSFS_readBytes(file, &contents[0], contents.size()) == length;
+	PHYSFS_close(file);
+	return ok;
+}
+
+static String attribute(const String &tag, const String &name)
+{
+	const String key   = name + "=\"";
+	const auto	 start = tag.find(key);
+	if (start == String::npos) return String();
+
+	const auto end = tag.find('"', start + key.size());
+	if (end == String::npos) return String();
+	return tag.substr(start + key.size(), end - start - key.size());
+}
+
+static String strip_rml_comments(const String &source)
+{
+	String result;
+	result.reserve(source.size());
+
+	size_t position = 0;
+	while (true) {
+		const auto start = source.find("<!--", position);
+		if (start == String::npos) break;
+		const auto end = source.find("-->", start + 4);
+		if (end == String::npos) break;
+
+		result.append(source, position, start - position);
+		position = end + 3;
+	}
+	result.append(source, position, String::npos);
+	return result;
+}
+
+// Drops comments and collapses whitespace, leaving quoted strings intact.
+// Whitespace next to braces and semicolons carries no meaning and goes too.
+static String minify_rcss(const String &source)
+{
+	auto is_space	= [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+	auto is_grammar = [](char c) { return c == '{' || c == '}' || c == ';'; };
+
+	String result;
+	result.reserve(source.size());
+
+	bool   pending_space = false;
+	size_t i			 = 0;
+	while (i < source.size()) {
+		const char c = source[i];
+
+		if (c == '/' && i + 1 < source.size() && source[i + 1] == '*') {
+			const auto end = source.find("*/", i + 2);
+			i			   = end == String::npos ? source.size() : end + 2;
+			pending_space  = true;
+			continue;
+		}
+		if (is_space(c)) {
+			pending_space = true;
+			i++;
+			continue;
+		}
+
+		if (pending_space && !result.empty() && !is_grammar(result.back()) && !is_grammar(c)) result += ' ';
+		pending_space = false;
+
+		if (c == '"' || c == '\'') {
+			auto end = source.find(c, i + 1);
+			end		 = end == String::npos ? source.size() : end + 1;
+			result.append(source, i, end - i);
+			i = end;
+			continue;
+		}
+
+		result += c;
+		i++;
+	}
+	return result;
+}
+
+DocumentCache::DocumentCache(const String &directory)
+	: directory{directory},
+	  stats{0, 0}
+{
+}
+
+ElementDocument *DocumentCache::LoadDocument(Context *context, const String &path)
+{
+	const String entry = EntryPath(path);
+
+	String document;
+	if (LoadEntry(entry, document)) {
+		stats.hits++;
+		return context->LoadDocumentFromMemory(document, path);
+	}
+
+	stats.misses++;
+	std::vector<Source> sources;
+	if (!Compile(path, document, sources)) return context->LoadDocument(path);
+
+	StoreEntry(entry, document, sources);
+	return context->LoadDocumentFromMemory(document, path);
+}
+
+void DocumentCache::Invalidate(const String &path)
+{
+	const String entry = EntryPath(path);
+	PHYSFS_delete((entry + ".dep").c_str());
+	PHYSFS_delete((entry + ".rml").c_str());
+}
+
+String DocumentCache::EntryPath(const String &path) const
+{
+	return CreateString(128, "%s/%016llx", directory.c_str(), static_cast<unsigned long long>(fnv1a(path)));
+}
+
+bool DocumentCache::LoadEntry(const String &entry, String &document)
+{
+	String manifest;
+	if (!read_file(entry + ".dep", manifest)) return false;
+
+	int				   version = 0;
+	unsigned long long hash	   = 0;
+	int				   offset  = 0;
+	if (sscanf(manifest.c_str(), "mlge-document %d %llx\n%n", &version, &hash, &offset) != 2 || version != CacheVersion)
+		return false;
+
+	// Every source must still be what the entry was built from.
+	const char *line = manifest.c_str() + offset;
+	String		source;
+	while (*line) {
+		unsigned long long size = 0, source_hash = 0;
+		int				   length = 0;
+		if (sscanf(line, "%llu %llx %n", &size, &source_hash, &length) != 2) return false;
+
+		const char *end = strchr(line + length, '\n');
+		if (!end) return false;
+
+		if (!read_file(String(line + length, end), source)) return false;
+		if (source.size() != size || fnv1a(source) != source_hash) return false;
+
+		line = end + 1;
+	}
+
+	return read_file(entry + ".rml", document) && fnv1a(document) == hash;
+}
+
+bool DocumentCache::Compile(const String &path, String &document, std::vector<Source> &sources)
+{
+	String source;
+	if (!read_file(path, source)) return false;
+	sources.push_back({path, source.size(), fnv1a(source)});
+
+	source = strip_rml_comments(source);
+
+	const auto	 slash = path.rfind('/');
+	const String base  = slash == String::npos ? String() : path.substr(0, slash + 1);
+
+	// Inline style sheets next to the document, their relative URLs resolve the
+	// same from the document. Anything else stays a link.
+	document.clear();
+	document.reserve(source.size());
+
+	size_t position = 0;
+	while (true) {
+		const auto start = source.find("<link", position);
+		if (start == String::npos) break;
+		const auto end = source.find('>', start);
+		if (end == String::npos) break;
+
+		document.append(source, position, start - position);
+		position = end + 1;
+
+		const String tag  = source.substr(start, end + 1 - start);
+		const String href = attribute(tag, "href");
+
+		String sheet;
+		if (attribute(tag, "type") == "text/css" && !href.empty() && href.find('/') == String::npos
+			&& read_file(base + href, sheet) && sheet.find('<') == String::npos) {
+			document += "<style>" + minify_rcss(sheet) + "</style>";
+			sources.push_back({base + href, sheet.size(), fnv1a(sheet)});
+		}
+		else
+			document += tag;
+	}
+	document.append(source, position, String::npos);
+	return true;
+}
+
+void DocumentCache::StoreEntry(const String &entry, const String &document, const std::vector<Source> &sources)
+{
+	String manifest = CreateString(64, "mlge-document %d %016llx\n", CacheVersion, static_cast<unsigned long long>(fnv1a(document)));
+	for (const auto &source : sources)
+		manifest += CreateString(64, "%llu %016llx ", static_cast<unsigned long long>(source.size),
+								 static_cast<unsigned long long>(source.hash))
+					+ source.path + "\n";
+
+	// The manifest goes last, a partially written entry never validates.
+	if (!save_file_data((entry + ".rml").c_str(), const_cast<char *>(document.data()), document.size())
+		|| !save_file_data((entry + ".dep").c_str(), &manifest[0], manifest.size()))
+		Log::Message(Log::LT_WARNING, "Failed to write document cache '%s', is the write directory set?", entry.c_str());
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <RmlUi/Core.h>
+
+#include <vector>
+
+// Startup cache of compiled RML documents in the PhysFS write directory.
+//
+// RmlUi has no serialized form of its parsed style sheets and templates, so
+// the cached form is the document with its local style sheets inlined and
+// comments and redundant whitespace stripped. A warm load reads the entry
+// and validates it against the size and content hash of every source it was
+// built from, instead of parsing, stripping and inlining them again. Content
+// hashes catch edits that keep a file's size and modification time, such as
+// copied or restored files.
+class DocumentCache
+{
+   public:
+	struct Stats
+	{
+		int hits;
+		int misses;
+	};
+
+	DocumentCache(const Rml::String &directory = "cache/documents");
+
+	// Drop-in for Context::LoadDocument().
+	Rml::ElementDocument *LoadDocument(Rml::Context *context, const Rml::String &path);
+
+	// Removes the cached entry, the next load is cold.
+	void Invalidate(const Rml::String &path);
+
+	const Stats &GetStats() const { return stats; }
+
+   private:
+	struct Source
+	{
+		Rml::String path;
+		size_t		size;
+		uint64_t	hash;  // FNV-1a of the contents
+	};
+
+	Rml::String directory;
+	Stats		stats;
+
+	Rml::String EntryPath(const Rml::String &path) const;
+	bool		LoadEntry(const Rml::String &entry, Rml::String &document);
+	bool		Compile(const Rml::String &path, Rml::String &document, std::vector<Source> &sources);
+	void		StoreEntry(const Rml::String &entry, const Rml::String &document, const std::vector<Source> &sources);
+};
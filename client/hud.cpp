@@ -0,0 +1,54 @@
+#include "hud.h"
+
+using namespace Rml;
+
+GameHud::GameHud(const String &model_name)
+	: model_name{model_name},
+	  initialised{false}
+{
+}
+
+GameHud::Field GameHud::Add(const String &name, const Variant &initial)
+{
+	RMLUI_ASSERT(!initialised);
+	values.push_back({name, initial, false});
+	return static_cast<Field>(values.size() - 1);
+}
+
+bool GameHud::Initialise(Context *context)
+{
+	DataModelConstructor constructor = context->CreateDataModel(model_name);
+	if (!constructor) return false;
+
+	// values does not grow after this point, the getters can keep indices.
+	for (size_t i = 0; i < values.size(); i++)
+		constructor.BindFunc(values[i].name, [this, i](Variant &variant) { variant = values[i].value; });
+
+	model		= constructor.GetModelHandle();
+	initialised = true;
+	return true;
+}
+
+void GameHud::Set(Field field, const Variant &value)
+{
+	auto &entry = values[field];
+	if (entry.value == value) return;
+
+	entry.value = value;
+	entry.dirty = true;
+}
+
+int GameHud::Sync()
+{
+	if (!initialised) return 0;
+
+	int changed = 0;
+	for (auto &entry : values) {
+		if (!entry.dirty) continue;
+
+		model.DirtyVariable(entry.name);
+		entry.dirty = false;
+		changed++;
+	}
+	return changed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <RmlUi/Core.h>
+
+#include <vector>
+
+// Game state exposed to RML through a data model, e.g. {{score}}.
+//
+// Values are pushed from game code with Set() and only the ones that actually
+// changed are marked dirty on Sync(), so RmlUi re-evaluates and lays out just
+// the elements bound to them instead of reparsing RML every frame.
+class GameHud
+{
+   public:
+	using Field = int;
+
+	GameHud(const Rml::String &model_name = "hud");
+
+	// Fields must be added before Initialise().
+	Field Add(const Rml::String &name, const Rml::Variant &initial = Rml::Variant(0));
+
+	// Must be called before loading documents that use the model.
+	bool Initialise(Rml::Context *context);
+
+	template <typename T>
+	void Set(Field field, const T &value)
+	{
+		Set(field, Rml::Variant(value));
+	}
+	void Set(Field field, const Rml::Variant &value);
+
+	// Propagates the changed fields to the data model, call before Context::Update().
+	int Sync();
+
+   private:
+	struct Value
+	{
+		Rml::String	 name;
+		Rml::Variant value;
+		bool		 dirty;
+	};
+
+	Rml::String			 model_name;
+	std::vector<Value>	 values;
+	Rml::DataModelHandle model;
+	bool				 initialised;
+};
@@ -4,16 +4,30 @@
 #include <cassert>
 #include <raylib-cpp.hpp>
 
+#include "async_io.h"
+#include "document_cache.h"
+#include "hud.h"
+#include "memtrack.h"
 #include "physfs.h"
+#include "profiler.h"
 #include "rml.h"
+#include "sdf_font.h"
 
-unsigned char *load_file_data(const char *fileName, unsigned int *bytesRead)
+// Reads the font while the window is already up, then loads the documents
+// using it; fonts must be loaded before the documents are.
+static AsyncTask load_ui(AsyncIO &io, Rml::Context *context, ProfilerOverlay &profiler_overlay, DocumentCache &document_cache)
 {
-	auto		   file		   = PHYSFS_openRead(fileName);
-	auto		   buffer_size = PHYSFS_fileLength(file);
-	unsigned char *buffer	   = static_cast<unsigned char *>(malloc(buffer_size));
-	*bytesRead				   = PHYSFS_readBytes(file, buffer, buffer_size);
-	return buffer;
+	FileData font = co_await io.Read("assets/PressStart2P-vaV7.ttf");
+	if (!font.ok || !Rml::LoadFontFace(font.bytes.data(), static_cast<int>(font.bytes.size()), "", Rml::Style::FontStyle::Normal))
+		TraceLog(LOG_WARNING, "FILEIO: Failed to load the UI font");
+
+	profiler_overlay.Initialise(context);
+
+	Rml::ElementDocument *document = document_cache.LoadDocument(context, "data/tutorial.rml");
+	if (document)
+		document->Show();
+	else
+		TraceLog(LOG_ERROR, "FILEIO: Failed to load data/tutorial.rml");
 }
 
 int main(int, char *argv[])
@@ -39,8 +53,34 @@ int main(int, char *argv[])
 	GameFileInterface file_interface(argv);
 	Rml::SetFileInterface(&file_interface);
 	SetLoadFileDataCallback(load_file_data);
+	SetSaveFileDataCallback(save_file_data);
+	SdfFontEngine font_engine;
+	font_engine.SetAtlasUpload([&](Rml::TextureHandle &handle, const Rml::byte *rgba, const Rml::Vector2i &dimensions) {
+		return render_interface.GenerateSdfTexture(handle, rgba, dimensions);
+	});
+	Rml::SetFontEngineInterface(&font_engine);
 
 	file_interface.mount("resources");
+	if (!file_interface.set_write_dir("mlge", "mlge")) TraceLog(LOG_WARNING, "FILEIO: No write directory, caches disabled");
+
+	// Asynchronous asset reads for coroutines, resumed once per frame.
+	AsyncIO async_io;
+	TraceLog(LOG_INFO, "FILEIO: Asynchronous reads via %s", async_io.IsUsingIoUring() ? "io_uring" : "thread pool");
+
+	// Memory per subsystem, over budget warnings to the log, report with F7.
+	MemoryMonitor memory;
+	memory.SetBudget(MemTag::UI, 64 << 20);
+	memory.SetBudget(MemTag::Graphics, 256 << 20);
+	memory.SetBudget(MemTag::Files, 32 << 20);
+	auto memory_warning = [](MemTag tag, const MemTagStats &stats, int64_t budget) {
+		TraceLog(LOG_WARNING, "MEMORY: %s over budget, %.2f MiB of %.2f MiB", mem_tag_name(tag), stats.live / 1048576.0,
+				 budget / 1048576.0);
+	};
+	auto memory_report = [](const char *line) { TraceLog(LOG_INFO, "MEMORY: %s", line); };
+
+	// The main thread is mostly RmlUi from here on, its allocations through
+	// operator new are accounted to the UI. raylib and PhysFS tag their own.
+	MemScope ui_scope(MemTag::UI);
 
 	// RmlUi initialisation.
 	Rml::Initialise();
@@ -51,16 +91,28 @@ int main(int, char *argv[])
 
 	Rml::Debugger::Initialise(context);
 
-	// Fonts should be loaded before any documents are loaded.
-	Rml::LoadFontFace("assets/PressStart2P-vaV7.ttf");
+	// Frame time overlay, toggled with F9.
+	FrameProfiler	profiler;
+	ProfilerOverlay profiler_overlay(profiler);
+
+	// Game state shown in documents through the "hud" data model. The score
+	// counts Space presses, until there is a game to keep it.
+	int					 score = 0;
+	GameHud				 hud;
+	const GameHud::Field hud_score = hud.Add("score", score);
+	hud.Initialise(context);
 
-	// Load and show the document.
-	Rml::ElementDocument *document = context->LoadDocument("data/tutorial.rml");
-	assert(document);
-	document->Show();
+	// Load the font, then show the documents, through the startup cache in
+	// the write directory.
+	DocumentCache document_cache;
+	AsyncTask	  ui_loading = load_ui(async_io, context, profiler_overlay, document_cache);
 
 	// Main game loop
 	while (!window.ShouldClose()) {	 // Detect window close button or ESC key
+		profiler.BeginFrame();
+
+		// Resume coroutines whose asset reads completed.
+		async_io.Poll();
 
 		// Submit input events before the call to Context::Update().
 
@@ -102,22 +154,43 @@ int main(int, char *argv[])
 			Rml::Debugger::SetVisible(!Rml::Debugger::IsVisible());
 		}
 
+		// Toggle the frame time overlay, dump the recorded frames.
+		if (IsKeyPressed(KEY_F9)) {
+			profiler_overlay.SetVisible(!profiler_overlay.IsVisible());
+		}
+		if (IsKeyPressed(KEY_F10)) {
+			if (profiler.DumpCSV("frames.csv"))
+				TraceLog(LOG_INFO, "PROFILER: %d frames written to %sframes.csv", profiler.GetSampleCount(), PHYSFS_getWriteDir());
+			else
+				TraceLog(LOG_WARNING, "PROFILER: failed to write frames.csv, is the write directory set?");
+		}
+
+		// Sample memory use, dump it on request.
+		memory.Update(GetTime(), memory_warning);
+		if (IsKeyPressed(KEY_F7)) memory.Report(memory_report);
+
 		// Update
 		//----------------------------------------------------------------------------------
+		profiler.BeginPhase(FramePhase::Update);
 		// Update your variables here
+		if (IsKeyPressed(KEY_SPACE)) score++;
+		profiler_overlay.Update(GetTime());
 		//----------------------------------------------------------------------------------
 
-		// Update any elements to reflect changed data.
-		// if (Rml::Element *el = document->GetElementById("score"))
-		//   el->SetInnerRML("Current score: " + my_application->GetScoreAsString());
+		// Update any elements to reflect changed data, only fields whose
+		// value changed get re-evaluated by the data bindings.
+		hud.Set(hud_score, score);
+		hud.Sync();
 
 		// Update the context to reflect any changes resulting from
 		// input events, animations, modified and added elements, or
 		// changed data in data bindings.
+		profiler.BeginPhase(FramePhase::UIUpdate);
 		context->Update();
 
 		// Draw
 		//----------------------------------------------------------------------------------
+		profiler.BeginPhase(FramePhase::Draw);
 		BeginDrawing();
 		{
 			window.ClearBackground(BLACK);
@@ -125,6 +198,7 @@ int main(int, char *argv[])
 
 			textColor.DrawText("All your codebase are belong to us", 216, 200, 20);
 
+			profiler.BeginPhase(FramePhase::UIRender);
 			// Set up any rendering states necessary before the render.
 			render_interface.BeginFrame();
 			// Render the user interface on top of the application.
@@ -132,10 +206,15 @@ int main(int, char *argv[])
 			// Present the rendered frame.
 			render_interface.EndFrame();
 		}
+		profiler.BeginPhase(FramePhase::Present);
 		EndDrawing();
+		profiler.EndFrame(render_interface.GetDrawCalls(), render_interface.GetVertices(), render_interface.GetCulledDraws(),
+						  render_interface.GetClipChanges());
 		//----------------------------------------------------------------------------------
 	}
 
+	memory.Report(memory_report);
+
 	// Shutdown RmlUi.
 	Rml::Shutdown();
 	// It is now safe to destroy the custom interfaces previously passed to RmlUi.
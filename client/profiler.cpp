@@ -0,0 +1,224 @@
+#include "profiler.h"
+
+#include "rml.h"
+
+using namespace Rml;
+
+// --- Frame Profiler ------------------------------------------------------
+
+template <typename Duration>
+static double to_ms(Duration duration)
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+FrameProfiler::FrameProfiler()
+	: samples{},
+	  head{0},
+	  count{0},
+	  frame_number{0},
+	  current{},
+	  current_phase{FramePhase::Input}
+{
+}
+
+void FrameProfiler::BeginFrame()
+{
+	current		  = {};
+	current_phase = FramePhase::Input;
+	frame_start = phase_start = Clock::now();
+}
+
+void FrameProfiler::BeginPhase(FramePhase phase)
+{
+	auto now = Clock::now();
+	current.phase_ms[static_cast<int>(current_phase)] += to_ms(now - phase_start);
+	phase_start	  = now;
+	current_phase = phase;
+}
+
+void FrameProfiler::EndFrame(int draw_calls, int vertices, int culled_draws, int clip_changes)
+{
+	auto now = Clock::now();
+	current.phase_ms[static_cast<int>(current_phase)] += to_ms(now - phase_start);
+	current.total_ms	 = to_ms(now - frame_start);
+	current.draw_calls	 = draw_calls;
+	current.vertices	 = vertices;
+	current.culled_draws = culled_draws;
+	current.clip_changes = clip_changes;
+
+	samples[head] = current;
+	head		  = (head + 1) % Capacity;
+	if (count < Capacity) count++;
+	frame_number++;
+}
+
+const FrameSample &FrameProfiler::GetSample(int age) const
+{
+	return samples[(head - 1 - age + Capacity) % Capacity];
+}
+
+Percentiles FrameProfiler::GetFrameTimePercentiles() const
+{
+	std::vector<double> totals(count);
+	for (int i = 0; i < count; i++) totals[i] = GetSample(i).total_ms;
+	return compute_percentiles(totals);
+}
+
+FrameSample FrameProfiler::GetAverage() const
+{
+	FrameSample average{};
+	if (!count) return average;
+
+	for (int i = 0; i < count; i++) {
+		const auto &sample = GetSample(i);
+		for (int phase = 0; phase < static_cast<int>(FramePhase::Count); phase++)
+			average.phase_ms[phase] += sample.phase_ms[phase] / count;
+		average.total_ms += sample.total_ms / count;
+		average.draw_calls += sample.draw_calls;
+		average.vertices += sample.vertices;
+		average.culled_draws += sample.culled_draws;
+		average.clip_changes += sample.clip_changes;
+	}
+	average.draw_calls /= count;
+	average.vertices /= count;
+	average.culled_draws /= count;
+	average.clip_changes /= count;
+	return average;
+}
+
+bool FrameProfiler::DumpCSV(const char *path) const
+{
+	String csv = "frame,input_ms,update_ms,ui_update_ms,draw_ms,ui_render_ms,present_ms,total_ms,draw_calls,vertices,culled_draws,clip_changes\n";
+	for (int age = count - 1; age >= 0; age--) {
+		const auto &sample = GetSample(age);
+		csv += CreateString(32, "%llu", static_cast<unsigned long long>(frame_number - 1 - age));
+		for (double phase_ms : sample.phase_ms) csv += CreateString(32, ",%.4f", phase_ms);
+		csv += CreateString(96, ",%.4f,%d,%d,%d,%d\n", sample.total_ms, sample.draw_calls, sample.vertices, sample.culled_draws,
+							sample.clip_changes);
+	}
+
+	return save_file_data(path, &csv[0], csv.size());
+}
+
+// --- Frame Graph Element -------------------------------------------------
+
+FrameGraphElement::FrameGraphElement(const String &tag, const FrameProfiler &profiler)
+	: Element(tag),
+	  profiler{profiler},
+	  geometry{this},
+	  frame_number{0}
+{
+}
+
+void FrameGraphElement::OnRender()
+{
+	if (frame_number != profiler.GetFrameNumber()) {
+		frame_number = profiler.GetFrameNumber();
+
+		const Vector2f size		  = GetBox().GetSize(Box::CONTENT);
+		const float	   bar_width  = size.x / FrameProfiler::Capacity;
+		const double   full_scale = 1000.0 / 30.0;	// ms at the top of the graph
+		const int	   bars		  = profiler.GetSampleCount();
+
+		geometry.Release(true);
+		auto &vertices = geometry.GetVertices();
+		auto &indices  = geometry.GetIndices();
+		vertices.resize((bars + 1) * 4);
+		indices.resize((bars + 1) * 6);
+
+		// Latest frame on the right.
+		for (int i = 0; i < bars; i++) {
+			const double total_ms = profiler.GetSample(i).total_ms;
+			const float	 height	  = size.y * static_cast<float>(std::min(total_ms / full_scale, 1.0));
+
+			Colourb colour(96, 200, 96);
+			if (total_ms > 1000.0 / 30.0)
+				colour = Colourb(220, 64, 64);
+			else if (total_ms > 1000.0 / 60.0)
+				colour = Colourb(220, 200, 64);
+
+			GeometryUtilities::GenerateQuad(&vertices[i * 4], &indices[i * 6],
+											Vector2f(size.x - (i + 1) * bar_width, size.y - height),
+											Vector2f(bar_width, height), colour, i * 4);
+		}
+
+		// 60 FPS frame budget
+		const float budget_y = size.y * static_cast<float>(1.0 - (1000.0 / 60.0) / full_scale);
+		GeometryUtilities::GenerateQuad(&vertices[bars * 4], &indices[bars * 6],
+										Vector2f(0, budget_y), Vector2f(size.x, 1), Colourb(255, 255, 255, 128), bars * 4);
+	}
+
+	geometry.Render(GetAbsoluteOffset(Box::CONTENT));
+}
+
+void FrameGraphElement::OnResize()
+{
+	frame_number = 0;  // rebuild with the new size on next render
+}
+
+ElementPtr FrameGraphInstancer::InstanceElement(Element *, const String &tag, const XMLAttributes &)
+{
+	return ElementPtr(new FrameGraphElement(tag, profiler));
+}
+
+void FrameGraphInstancer::ReleaseElement(Element *element)
+{
+	delete element;
+}
+
+// --- Profiler Overlay ----------------------------------------------------
+
+ProfilerOverlay::ProfilerOverlay(const FrameProfiler &profiler)
+	: profiler{profiler},
+	  instancer{profiler},
+	  document{nullptr},
+	  last_refresh{0}
+{
+}
+
+void ProfilerOverlay::Initialise(Context *context)
+{
+	Factory::RegisterElementInstancer("framegraph", &instancer);
+
+	document = context->LoadDocument("data/profiler.rml");
+}
+
+void ProfilerOverlay::Update(double time)
+{
+	if (!IsVisible() || time - last_refresh < 0.25) return;
+	last_refresh = time;
+
+	Element *stats = document->GetElementById("stats");
+	if (!stats) return;
+
+	const Percentiles frame	  = profiler.GetFrameTimePercentiles();
+	const FrameSample average = profiler.GetAverage();
+	auto			  phase	  = [&](FramePhase phase) { return average.phase_ms[static_cast<int>(phase)]; };
+
+	stats->SetInnerRML(CreateString(512,
+									"frame ms p50 %.2f p90 %.2f p99 %.2f max %.2f<br/>"
+									"input %.2f update %.2f ui %.2f<br/>"
+									"draw %.2f render %.2f present %.2f<br/>"
+									"draws %d vertices %d<br/>"
+									"culled %d clip changes %d",
+									frame.p50, frame.p90, frame.p99, frame.max,
+									phase(FramePhase::Input), phase(FramePhase::Update), phase(FramePhase::UIUpdate),
+									phase(FramePhase::Draw), phase(FramePhase::UIRender), phase(FramePhase::Present),
+									average.draw_calls, average.vertices, average.culled_draws, average.clip_changes));
+}
+
+bool ProfilerOverlay::IsVisible() const
+{
+	return document && document->IsVisible();
+}
+
+void ProfilerOverlay::SetVisible(bool visible)
+{
+	if (!document) return;
+
+	if (visible)
+		document->Show(ModalFlag::None, FocusFlag::None);
+	else
+		document->Hide();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <RmlUi/Core.h>
+
+#include <array>
+#include <chrono>
+
+#include "stats.h"
+
+enum class FramePhase {
+	Input,
+	Update,		 // game state
+	UIUpdate,	 // Context::Update()
+	Draw,		 // scene
+	UIRender,	 // Context::Render()
+	Present,	 // EndDrawing(), includes the frame limiter wait
+	Count
+};
+
+struct FrameSample
+{
+	double phase_ms[static_cast<int>(FramePhase::Count)];
+	double total_ms;
+	int	   draw_calls;
+	int	   vertices;
+	int	   culled_draws;
+	int	   clip_changes;
+};
+
+// Per-phase CPU frame times kept in a ring buffer.
+class FrameProfiler
+{
+   public:
+	static const int Capacity = 300;
+
+	FrameProfiler();
+
+	void BeginFrame();
+	void BeginPhase(FramePhase phase);
+	void EndFrame(int draw_calls, int vertices, int culled_draws = 0, int clip_changes = 0);
+
+	int				   GetSampleCount() const { return count; }
+	const FrameSample &GetSample(int age) const;  // 0 is the latest frame
+	uint64_t		   GetFrameNumber() const { return frame_number; }
+
+	Percentiles GetFrameTimePercentiles() const;
+	FrameSample GetAverage() const;
+
+	// Writes the recorded frames to `path` in the PhysFS write directory.
+	bool DumpCSV(const char *path) const;
+
+   private:
+	using Clock = std::chrono::steady_clock;
+
+	std::array<FrameSample, Capacity> samples;
+	int								  head;
+	int								  count;
+	uint64_t						  frame_number;
+
+	FrameSample		  current;
+	FramePhase		  current_phase;
+	Clock::time_point frame_start;
+	Clock::time_point phase_start;
+};
+
+// Bar graph of the recorded frame times, <framegraph> in RML.
+class FrameGraphElement : public Rml::Element
+{
+	const FrameProfiler &profiler;
+	Rml::Geometry		 geometry;
+	uint64_t			 frame_number;
+
+   public:
+	FrameGraphElement(const Rml::String &tag, const FrameProfiler &profiler);
+
+   protected:
+	void OnRender() override;
+	void OnResize() override;
+};
+
+class FrameGraphInstancer : public Rml::ElementInstancer
+{
+	const FrameProfiler &profiler;
+
+   public:
+	FrameGraphInstancer(const FrameProfiler &profiler) : profiler{profiler} {}
+
+	Rml::ElementPtr InstanceElement(Rml::Element *parent, const Rml::String &tag, const Rml::XMLAttributes &attributes) override;
+	void			ReleaseElement(Rml::Element *element) override;
+};
+
+// Frame time overlay document, shown on top of everything else.
+class ProfilerOverlay
+{
+	const FrameProfiler	 &profiler;
+	FrameGraphInstancer	  instancer;
+	Rml::ElementDocument *document;
+	double				  last_refresh;
+
+   public:
+	ProfilerOverlay(const FrameProfiler &profiler);
+
+	// Must be called after Rml::Initialise() and before documents using <framegraph> are loaded.
+	void Initialise(Rml::Context *context);
+	void Update(double time);
+
+	bool IsVisible() const;
+	void SetVisible(bool visible);
+};
@@ -0,0 +1,122 @@
+#include "recording_render.h"
+
+#include <raylib.h>
+
+using namespace Rml;
+
+RecordingRenderInterface::RecordingRenderInterface()
+	: frame{},
+	  total{},
+	  bound_texture{0},
+	  next_texture{0},
+	  transform{nullptr},
+	  viewport_width{0},
+	  viewport_height{0}
+{
+}
+
+void RecordingRenderInterface::SetViewport(int width, int height)
+{
+	viewport_width	= width;
+	viewport_height = height;
+}
+
+void RecordingRenderInterface::Count(int RenderStats::*field, int amount)
+{
+	frame.*field += amount;
+	total.*field += amount;
+}
+
+void RecordingRenderInterface::BeginFrame()
+{
+	frame		  = {};
+	bound_texture = 0;
+	stream.clear();
+	clip.Reset(viewport_width, viewport_height);
+}
+
+void RecordingRenderInterface::RenderGeometry(Vertex *vertices, int num_vertices,
+											  int *indices, int num_indices,
+											  TextureHandle	  texture_handle,
+											  const Vector2f &translation)
+{
+	if (!clip.IsVisible(vertices, num_vertices, translation, transform)) {
+		Count(&RenderStats::culled_calls);
+		return;
+	}
+	if (clip.Apply()) Count(&RenderStats::scissor_changes);
+	if (clip.GetApplied().enabled) Count(&RenderStats::scissored_calls);
+
+	struct StreamSink
+	{
+		std::vector<EmittedVertex> &stream;
+		Vector2f					translation;
+
+		void Vertex(const Rml::Vertex &vertex)
+		{
+			stream.push_back({vertex.position.x + translation.x, vertex.position.y + translation.y,
+							  vertex.tex_coord.x, vertex.tex_coord.y, vertex.colour});
+		}
+		void Repeat(const Rml::Vertex &)
+		{
+			stream.push_back(stream.back());
+		}
+	} sink{stream, translation};
+
+	const size_t emitted = stream.size();
+	emit_quads(sink, vertices, num_vertices, indices, num_indices);
+
+	Count(&RenderStats::geometry_calls);
+	Count(&RenderStats::vertices, static_cast<int>(stream.size() - emitted));
+	if (texture_handle != bound_texture) {
+		Count(&RenderStats::texture_binds);
+		bound_texture = texture_handle;
+	}
+}
+
+void RecordingRenderInterface::EnableScissorRegion(bool enable)
+{
+	clip.Enable(enable);
+}
+
+void RecordingRenderInterface::SetScissorRegion(int x, int y, int width, int height)
+{
+	clip.SetRegion(x, y, width, height);
+}
+
+bool RecordingRenderInterface::LoadTexture(TextureHandle &texture_handle, Vector2i &texture_dimensions, const String &source)
+{
+	// Decoded on the CPU only, to get the dimensions and size right.
+	Image image = LoadImage(source.c_str());
+	if (!image.data) return false;
+
+	texture_dimensions = Vector2i(image.width, image.height);
+	texture_handle	   = static_cast<TextureHandle>(++next_texture);
+
+	Count(&RenderStats::textures_loaded);
+	frame.texture_bytes += GetPixelDataSize(image.width, image.height, image.format);
+	total.texture_bytes += GetPixelDataSize(image.width, image.height, image.format);
+
+	UnloadImage(image);
+	return true;
+}
+
+bool RecordingRenderInterface::GenerateTexture(TextureHandle &texture_handle, const byte *, const Vector2i &source_dimensions)
+{
+	texture_handle = static_cast<TextureHandle>(++next_texture);
+
+	Count(&RenderStats::textures_generated);
+	frame.texture_bytes += source_dimensions.x * source_dimensions.y * 4;
+	total.texture_bytes += source_dimensions.x * source_dimensions.y * 4;
+	return true;
+}
+
+void RecordingRenderInterface::ReleaseTexture(TextureHandle)
+{
+}
+
+void RecordingRenderInterface::SetTransform(const Matrix4f *transform)
+{
+	this->transform = transform;
+	Count(&RenderStats::transform_changes);
+}
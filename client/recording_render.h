@@ -0,0 +1,78 @@
+#pragma once
+
+#include <RmlUi/Core.h>
+
+#include <vector>
+
+#include "rml.h"
+
+struct RenderStats
+{
+	int	   geometry_calls;
+	int	   vertices;  // emitted into the quad stream
+	int	   texture_binds;
+	int	   culled_calls;	 // outside the clip or viewport, not emitted
+	int	   scissored_calls;	 // emitted with the scissor enabled
+	int	   scissor_changes;	 // applied scissor transitions, each one a batch flush
+	int	   transform_changes;
+	int	   textures_loaded;
+	int	   textures_generated;
+	size_t texture_bytes;
+};
+
+// Render interface without a GPU: geometry goes through the same quad
+// expansion as GameRenderInterface into a CPU-side vertex stream, textures
+// are only sized. Clipping and culling follow GameRenderInterface. Used for
+// headless UI benchmarks.
+class RecordingRenderInterface : public Rml::RenderInterface
+{
+   public:
+	struct EmittedVertex
+	{
+		float		  x, y;
+		float		  u, v;
+		Rml::Colourb colour;
+	};
+
+	RecordingRenderInterface();
+	virtual ~RecordingRenderInterface() = default;
+
+	// Geometry outside the viewport is culled, 0 for unbounded.
+	void SetViewport(int width, int height);
+
+	void BeginFrame();
+	void EndFrame() {}
+
+	const RenderStats				  &GetFrameStats() const { return frame; }
+	const RenderStats				  &GetTotalStats() const { return total; }
+	const std::vector<EmittedVertex> &GetVertexStream() const { return stream; }
+
+	void RenderGeometry(Rml::Vertex *vertices, int num_vertices, int *indices,
+						int num_indices, Rml::TextureHandle texture,
+						const Rml::Vector2f &translation) override;
+
+	void EnableScissorRegion(bool enable) override;
+	void SetScissorRegion(int x, int y, int width, int height) override;
+
+	bool LoadTexture(Rml::TextureHandle &texture_handle,
+					 Rml::Vector2i		&texture_dimensions,
+					 const Rml::String	&source) override;
+	bool GenerateTexture(Rml::TextureHandle	 &texture_handle,
+						 const Rml::byte	 *source,
+						 const Rml::Vector2i &source_dimensions) override;
+	void ReleaseTexture(Rml::TextureHandle texture) override;
+
+	void SetTransform(const Rml::Matrix4f *transform) override;
+
+   private:
+	RenderStats				   frame;
+	RenderStats				   total;
+	std::vector<EmittedVertex> stream;
+	Rml::TextureHandle		   bound_texture;
+	uintptr_t				   next_texture;
+	ClipTracker				   clip;
+	const Rml::Matrix4f		  *transform;
+	int						   viewport_width, viewport_height;
+
+	void Count(int RenderStats::*field, int amount = 1);
+};
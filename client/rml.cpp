@@ -2,24 +2,54 @@
 
 #include <physfs.h>
 
+#include "memtrack.h"
+
 using namespace Rml;
 
 // --- Render Interface ----------------------------------------------------
 
+// Distance field stored in alpha, 0.5 on the glyph edge, antialiased over
+// one screen pixel.
+static const char *sdf_fragment_shader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;
+uniform vec4 colDiffuse;
+
+out vec4 finalColor;
+
+void main()
+{
+	float distance = texture(texture0, fragTexCoord).a - 0.5;
+	float width = length(vec2(dFdx(distance), dFdy(distance)));
+	float alpha = smoothstep(-width, width, distance);
+	finalColor = vec4(fragColor.rgb, fragColor.a*alpha)*colDiffuse;
+}
+)";
+
+static bool is_sdf_texture(const String &source)
+{
+	static const String suffix = ".sdf.png";
+	return source.size() >= suffix.size() && source.compare(source.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
 GameRenderInterface::GameRenderInterface()
 	: default_texture_id{0},
-	  scissor{false},
-	  scissor_x{0},
-	  scissor_y{0},
-	  scissor_width{0},
-	  scissor_height{0},
-	  transform{nullptr}
+	  transform{nullptr},
+	  frame_draw_calls{0},
+	  frame_vertices{0},
+	  frame_culled_draws{0},
+	  frame_clip_changes{0},
+	  sdf_active{false}
 {
-	batch = rlLoadRenderBatch(RL_DEFAULT_BATCH_BUFFERS, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+	batch	   = rlLoadRenderBatch(RL_DEFAULT_BATCH_BUFFERS, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+	sdf_shader = LoadShaderFromMemory(nullptr, sdf_fragment_shader);
 }
 
 GameRenderInterface::~GameRenderInterface()
 {
+	UnloadShader(sdf_shader);
 	rlUnloadRenderBatch(batch);
 }
 
@@ -27,10 +57,20 @@ void GameRenderInterface::BeginFrame()
 {
 	rlSetRenderBatchActive(&batch);
 	default_texture_id = batch.draws[0].textureId;
+	frame_draw_calls   = 0;
+	frame_vertices	   = 0;
+	frame_culled_draws = 0;
+	frame_clip_changes = 0;
+	clip.Reset(GetScreenWidth(), GetScreenHeight());
 }
 
 void GameRenderInterface::EndFrame()
 {
+	if (clip.GetApplied().enabled) EndScissorMode();
+	if (sdf_active) {
+		EndShaderMode();
+		sdf_active = false;
+	}
 	rlSetRenderBatchActive(nullptr);
 }
 
@@ -39,7 +79,20 @@ void GameRenderInterface::RenderGeometry(Vertex *vertices, int num_vertices,
 										 TextureHandle	 texture_handle,
 										 const Vector2f &translation)
 {
-	if (scissor) BeginScissorMode(scissor_x, scissor_y, scissor_width, scissor_height);
+	if (!clip.IsVisible(vertices, num_vertices, translation, transform)) {
+		frame_culled_draws++;
+		return;
+	}
+
+	// Changing the scissor flushes the batch, so only do it on a real change.
+	if (clip.Apply()) {
+		const ClipRect &rect = clip.GetApplied();
+		if (rect.enabled)
+			BeginScissorMode(rect.x, rect.y, rect.width, rect.height);
+		else
+			EndScissorMode();
+		frame_clip_changes++;
+	}
 
 	rlPushMatrix();
 
@@ -48,45 +101,54 @@ void GameRenderInterface::RenderGeometry(Vertex *vertices, int num_vertices,
 		rlMultMatrixf(transform->data());
 	}
 
-	// Texturing is only supported on RL_QUADS
-	rlBegin(RL_QUADS);
-
-	if (texture_handle)
-		rlSetTexture(reinterpret_cast<raylib::Texture *>(texture_handle)->id);
-	else
-		rlSetTexture(default_texture_id);
-
-	for (int index = 0; index < num_indices; index++) {
-		auto vertex_index = indices[index];
-		if (vertex_index > num_vertices) continue;
+	const unsigned int texture_id = texture_handle ? reinterpret_cast<raylib::Texture *>(texture_handle)->id : default_texture_id;
 
-		auto vertex = &vertices[vertex_index];
+	// Switching shaders flushes the batch, so only do it when needed.
+	const bool sdf = sdf_textures.count(texture_id) > 0;
+	if (sdf != sdf_active) {
+		if (sdf)
+			BeginShaderMode(sdf_shader);
+		else
+			EndShaderMode();
+		sdf_active = sdf;
+	}
 
-		rlColor4ub(vertex->colour.red, vertex->colour.green, vertex->colour.blue, vertex->colour.alpha);
-		rlTexCoord2f(vertex->tex_coord.x, vertex->tex_coord.y);
-		rlVertex2f(vertex->position.x, vertex->position.y);
+	// Texturing is only supported on RL_QUADS
+	rlBegin(RL_QUADS);
 
-		if (index % 3 == 2)	 // duplicate every third vertex to create quad
-			rlVertex2f(vertex->position.x, vertex->position.y);
-	}
+	rlSetTexture(texture_id);
+
+	struct RlglSink
+	{
+		void Vertex(const Rml::Vertex &vertex)
+		{
+			rlColor4ub(vertex.colour.red, vertex.colour.green, vertex.colour.blue, vertex.colour.alpha);
+			rlTexCoord2f(vertex.tex_coord.x, vertex.tex_coord.y);
+			rlVertex2f(vertex.position.x, vertex.position.y);
+		}
+		void Repeat(const Rml::Vertex &vertex)
+		{
+			rlVertex2f(vertex.position.x, vertex.position.y);
+		}
+	} sink;
+	emit_quads(sink, vertices, num_vertices, indices, num_indices);
 	rlEnd();
 
 	rlPopMatrix();
 	rlSetTexture(0);
-	if (scissor) EndScissorMode();
+
+	frame_draw_calls++;
+	frame_vertices += num_indices + num_indices / 3;
 }
 
 void GameRenderInterface::EnableScissorRegion(bool enable)
 {
-	scissor = enable;
+	clip.Enable(enable);
 }
 
 void GameRenderInterface::SetScissorRegion(int x, int y, int width, int height)
 {
-	scissor_x	   = x;
-	scissor_y	   = y;
-	scissor_width  = width;
-	scissor_height = height;
+	clip.SetRegion(x, y, width, height);
 }
 
 bool GameRenderInterface::LoadTexture(TextureHandle &texture_handle, Vector2i &texture_dimensions, const String &source)
@@ -95,6 +157,10 @@ bool GameRenderInterface::LoadTexture(TextureHandle &texture_handle, Vector2i &t
 		auto texture	   = new raylib::Texture(source);
 		texture_handle	   = reinterpret_cast<TextureHandle>(texture);
 		texture_dimensions = Vector2i(texture->width, texture->height);
+		if (is_sdf_texture(source)) {
+			texture->SetFilter(TEXTURE_FILTER_BILINEAR);
+			sdf_textures.insert(texture->id);
+		}
 		return true;
 	}
 	catch (raylib::RaylibException e) {
@@ -116,9 +182,21 @@ bool GameRenderInterface::GenerateTexture(TextureHandle &texture_handle, const b
 	}
 }
 
+bool GameRenderInterface::GenerateSdfTexture(TextureHandle &texture_handle, const byte *source, const Vector2i &source_dimensions)
+{
+	if (!GenerateTexture(texture_handle, source, source_dimensions)) return false;
+
+	auto texture = reinterpret_cast<raylib::Texture *>(texture_handle);
+	texture->SetFilter(TEXTURE_FILTER_BILINEAR);
+	sdf_textures.insert(texture->id);
+	return true;
+}
+
 void GameRenderInterface::ReleaseTexture(TextureHandle texture_handle)
 {
-	delete reinterpret_cast<raylib::Texture *>(texture_handle);
+	auto texture = reinterpret_cast<raylib::Texture *>(texture_handle);
+	sdf_textures.erase(texture->id);
+	delete texture;
 }
 
 void GameRenderInterface::SetTransform(const Matrix4f *transform)
@@ -217,8 +295,59 @@ void GameSystemInterface::GetClipboardText(String &text)
 
 // --- File Interface ----------------------------------------------------
 
+// Allocated with MemAlloc(), raylib releases it with UnloadFileData().
+unsigned char *load_file_data(const char *fileName, unsigned int *bytesRead)
+{
+	*bytesRead = 0;
+
+	auto file = PHYSFS_openRead(fileName);
+	if (!file) return nullptr;
+
+	auto		   buffer_size = PHYSFS_fileLength(file);
+	unsigned char *buffer	   = buffer_size >= 0 ? static_cast<unsigned char *>(MemAlloc(buffer_size)) : nullptr;
+	if (buffer) {
+		auto read = PHYSFS_readBytes(file, buffer, buffer_size);
+		if (read == buffer_size)
+			*bytesRead = static_cast<unsigned int>(read);
+		else {
+			MemFree(buffer);
+			buffer = nullptr;
+		}
+	}
+	PHYSFS_close(file);
+	return buffer;
+}
+
+bool save_file_data(const char *fileName, void *data, unsigned int bytesToWrite)
+{
+	String directory = fileName;
+	auto   slash	 = directory.rfind('/');
+	if (slash != String::npos) {
+		directory.resize(slash);
+		PHYSFS_mkdir(directory.c_str());
+	}
+
+	auto file = PHYSFS_openWrite(fileName);
+	if (!file) return false;
+	auto written = PHYSFS_writeBytes(file, data, bytesToWrite);
+	PHYSFS_close(file);
+	return written == bytesToWrite;
+}
+
+// PhysFS buffers accounted as files, see memtrack.h.
+static PHYSFS_Allocator file_allocator = {
+	nullptr,
+	nullptr,
+	[](PHYSFS_uint64 size) { return size > SIZE_MAX ? nullptr : mem_alloc(static_cast<size_t>(size), MemTag::Files); },
+	[](void *block, PHYSFS_uint64 size) {
+		return size > SIZE_MAX ? nullptr : mem_realloc(block, static_cast<size_t>(size), MemTag::Files);
+	},
+	[](void *block) { mem_free(block); },
+};
+
 GameFileInterface::GameFileInterface(char *argv[])
 {
+	PHYSFS_setAllocator(&file_allocator);
 	PHYSFS_init(argv[0]);
 }
 
@@ -270,6 +399,13 @@ void GameFileInterface::mount(Rml::String const &newDir, Rml::String const &moun
 	PHYSFS_mount(newDir.c_str(), mountPoint.c_str(), appendToPath);
 }
 
+bool GameFileInterface::set_write_dir(Rml::String const &organization, Rml::String const &application)
+{
+	const char *pref_dir = PHYSFS_getPrefDir(organization.c_str(), application.c_str());
+	if (!pref_dir || !PHYSFS_setWriteDir(pref_dir)) return false;
+	return PHYSFS_mount(pref_dir, "/", true);
+}
+
 // --- KeyConversion ----------------------------------------------------
 // TODO: make it a look-up table
 Input::KeyIdentifier raylib_key_to_identifier(KeyboardKey key)
@@ -1,17 +1,142 @@
+#pragma once
+
 #include <RmlUi/Core.h>
 
+#include <algorithm>
 #include <raylib-cpp.hpp>
+#include <unordered_set>
 #include <vector>
 
 #include "rlgl.h"
 
+// Expands RmlUi triangles into an RL_QUADS vertex stream: texturing in rlgl
+// is only supported on quads, so the last vertex of every triangle is
+// repeated. Sink receives Vertex() for full vertices and Repeat() for the
+// duplicated position.
+template <typename Sink>
+inline void emit_quads(Sink &sink, const Rml::Vertex *vertices, int num_vertices, const int *indices, int num_indices)
+{
+	for (int index = 0; index < num_indices; index++) {
+		auto vertex_index = indices[index];
+		if (vertex_index >= num_vertices) continue;
+
+		const auto &vertex = vertices[vertex_index];
+
+		sink.Vertex(vertex);
+		if (index % 3 == 2)	 // duplicate every third vertex to create quad
+			sink.Repeat(vertex);
+	}
+}
+
+struct ClipRect
+{
+	bool enabled;
+	int	 x, y, width, height;
+
+	bool operator==(const ClipRect &other) const
+	{
+		return enabled == other.enabled
+			&& (!enabled || (x == other.x && y == other.y && width == other.width && height == other.height));
+	}
+	bool operator!=(const ClipRect &other) const { return !(*this == other); }
+};
+
+// Scissor state as requested by RmlUi versus the one last applied by the
+// backend. RmlUi sets the scissor before every element, mostly to the same
+// rectangle, while changing it flushes the batch; Apply() reports only real
+// transitions. IsVisible() culls geometry whose transformed bounds fall
+// entirely outside the clip and the viewport, like rows scrolled out of a list.
+class ClipTracker
+{
+	ClipRect requested;
+	ClipRect applied;
+	int		 viewport_width, viewport_height;  // 0 for unbounded
+
+   public:
+	ClipTracker() : requested{}, applied{}, viewport_width{0}, viewport_height{0} {}
+
+	// Starts a frame with no scissor applied.
+	void Reset(int width, int height)
+	{
+		applied			= {};
+		viewport_width	= width;
+		viewport_height = height;
+	}
+
+	void Enable(bool enable) { requested.enabled = enable; }
+	void SetRegion(int x, int y, int width, int height)
+	{
+		requested.x		 = x;
+		requested.y		 = y;
+		requested.width	 = width;
+		requested.height = height;
+	}
+
+	// Makes the requested clip the applied one, returns whether it changed.
+	bool Apply()
+	{
+		if (requested == applied) return false;
+		applied = requested;
+		return true;
+	}
+	const ClipRect &GetApplied() const { return applied; }
+
+	bool IsVisible(const Rml::Vertex *vertices, int num_vertices, const Rml::Vector2f &translation,
+				   const Rml::Matrix4f *transform) const
+	{
+		if (num_vertices <= 0) return false;
+
+		float left = vertices[0].position.x, right = left;
+		float top = vertices[0].position.y, bottom = top;
+		for (int i = 1; i < num_vertices; i++) {
+			const auto &position = vertices[i].position;
+			left				 = std::min(left, position.x);
+			right				 = std::max(right, position.x);
+			top					 = std::min(top, position.y);
+			bottom				 = std::max(bottom, position.y);
+		}
+		left += translation.x;
+		right += translation.x;
+		top += translation.y;
+		bottom += translation.y;
+
+		if (transform) {
+			const Rml::Vector2f corners[] = {{left, top}, {right, top}, {left, bottom}, {right, bottom}};
+			for (int i = 0; i < 4; i++) {
+				const Rml::Vector4f projected = *transform * Rml::Vector4f(corners[i].x, corners[i].y, 0, 1);
+				if (projected.w <= 0) return true;	// crosses the camera plane, bounds are meaningless
+
+				const float x = projected.x / projected.w, y = projected.y / projected.w;
+				left		  = i ? std::min(left, x) : x;
+				right		  = i ? std::max(right, x) : x;
+				top			  = i ? std::min(top, y) : y;
+				bottom		  = i ? std::max(bottom, y) : y;
+			}
+		}
+
+		if (viewport_width > 0 && (right <= 0 || left >= viewport_width || bottom <= 0 || top >= viewport_height))
+			return false;
+		if (requested.enabled
+			&& (right <= requested.x || left >= requested.x + requested.width || bottom <= requested.y
+				|| top >= requested.y + requested.height))
+			return false;
+		return true;
+	}
+};
+
 class GameRenderInterface : public Rml::RenderInterface
 {
 	rlRenderBatch		 batch;
 	unsigned int		 default_texture_id;
-	bool				 scissor;
-	int					 scissor_x, scissor_y, scissor_width, scissor_height;
+	ClipTracker			 clip;
 	const Rml::Matrix4f *transform;
+	int					 frame_draw_calls;
+	int					 frame_vertices;
+	int					 frame_culled_draws;
+	int					 frame_clip_changes;
+	Shader				 sdf_shader;
+	bool				 sdf_active;
+	std::unordered_set<unsigned int> sdf_textures;	// drawn with sdf_shader
 
    public:
 	GameRenderInterface();
@@ -20,6 +145,13 @@ class GameRenderInterface : public Rml::RenderInterface
 	void BeginFrame();
 	void EndFrame();
 
+	// RenderGeometry() calls and vertices emitted since BeginFrame().
+	int GetDrawCalls() const { return frame_draw_calls; }
+	int GetVertices() const { return frame_vertices; }
+	// RenderGeometry() calls culled against the clip, and clip changes applied.
+	int GetCulledDraws() const { return frame_culled_draws; }
+	int GetClipChanges() const { return frame_clip_changes; }
+
 	void RenderGeometry(Rml::Vertex *vertices, int num_vertices, int *indices,
 						int num_indices, Rml::TextureHandle texture,
 						const Rml::Vector2f &translation) override;
@@ -35,6 +167,9 @@ class GameRenderInterface : public Rml::RenderInterface
 						 const Rml::Vector2i &source_dimensions) override;
 	void ReleaseTexture(Rml::TextureHandle texture) override;
 
+	// GenerateTexture() for a distance field atlas, see SdfFontEngine::SetAtlasUpload().
+	bool GenerateSdfTexture(Rml::TextureHandle &texture_handle, const Rml::byte *source, const Rml::Vector2i &source_dimensions);
+
 	void SetTransform(const Rml::Matrix4f *transform) override;
 };
 
@@ -53,6 +188,10 @@ class GameSystemInterface : public Rml::SystemInterface
 	void   GetClipboardText(Rml::String &text) override;
 };
 
+// raylib LoadFileData/SaveFileData callbacks going through PhysFS.
+unsigned char *load_file_data(const char *fileName, unsigned int *bytesRead);
+bool		   save_file_data(const char *fileName, void *data, unsigned int bytesToWrite);
+
 class GameFileInterface : public Rml::FileInterface
 {
    public:
@@ -67,4 +206,6 @@ class GameFileInterface : public Rml::FileInterface
 	size_t			Length(Rml::FileHandle file) override;
 
 	void mount(Rml::String const &newDir, Rml::String const &mountPoint = "/", bool appendToPath = true);
+	// Sets the per-user write directory and mounts it at the root, so written files are readable under the same path.
+	bool set_write_dir(Rml::String const &organization, Rml::String const &application);
 };
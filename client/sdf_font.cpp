@@ -0,0 +1,399 @@
+#include "sdf_font.h"
+
+#include <physfs.h>
+#include <raylib.h>
+
+#include <algorithm>
+#include <cstring>
+
+using namespace Rml;
+
+// Glyph images from raylib's SDF loader are padded by this much on every side
+// (FONT_SDF_CHAR_PADDING in rtext.c).
+static const int SdfPadding = 4;
+
+static const uint32_t AtlasMagic   = 0x46445353;  // "SSDF"
+static const uint32_t AtlasVersion = 1;
+
+struct AtlasHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	int32_t	 base_size;
+	int32_t	 atlas_width, atlas_height;
+	int32_t	 glyph_count;
+	float	 baseline, x_height;
+};
+
+struct AtlasGlyph
+{
+	uint32_t codepoint;
+	float	 advance, offset_x, offset_y;
+	float	 x, y, width, height;
+};
+
+static uint64_t fnv1a(const byte *data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 0x100000001b3ull;
+	return hash;
+}
+
+static String to_lower(String string)
+{
+	for (auto &c : string)
+		if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+	return string;
+}
+
+static uint16_t read_u16(const byte *p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+static uint32_t read_u32(const byte *p) { return static_cast<uint32_t>(p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3]); }
+
+// Family name (nameID 1) from the TrueType/OpenType 'name' table.
+static String font_family_name(const byte *data, size_t size)
+{
+	if (size < 12) return String();
+
+	const uint16_t num_tables = read_u16(data + 4);
+	for (uint16_t i = 0; i < num_tables; i++) {
+		const byte *record = data + 12 + 16 * i;
+		if (record + 16 > data + size) break;
+		if (memcmp(record, "name", 4) != 0) continue;
+
+		const uint32_t table = read_u32(record + 8);
+		if (table + 6 > size) break;
+
+		const uint16_t count   = read_u16(data + table + 2);
+		const uint32_t strings = table + read_u16(data + table + 4);
+		for (uint16_t n = 0; n < count; n++) {
+			const byte *name = data + table + 6 + 12 * n;
+			if (name + 12 > data + size) break;
+
+			const uint16_t platform = read_u16(name);
+			const uint16_t name_id	= read_u16(name + 6);
+			const uint16_t length	= read_u16(name + 8);
+			const uint32_t offset	= strings + read_u16(name + 10);
+			if (name_id != 1 || offset + length > size) continue;
+
+			String family;
+			if (platform == 0 || platform == 3) {  // UTF-16BE, keep it to Latin-1
+				for (uint16_t c = 0; c + 1 < length; c += 2)
+					if (data[offset + c] == 0) family += static_cast<char>(data[offset + c + 1]);
+			}
+			else if (platform == 1) {
+				family.assign(reinterpret_cast<const char *>(data + offset), length);
+			}
+			if (!family.empty()) return family;
+		}
+	}
+	return String();
+}
+
+SdfFontEngine::SdfFontEngine(int base_size)
+	: base_size{base_size}
+{
+}
+
+SdfFontEngine::~SdfFontEngine()
+{
+	ReleaseFontResources();
+}
+
+bool SdfFontEngine::LoadFontFace(const String &file_name, bool fallback_face, Style::FontWeight weight)
+{
+	FileInterface *file_interface = GetFileInterface();
+	FileHandle	   file			  = file_interface->Open(file_name);
+	if (!file) {
+		Log::Message(Log::LT_ERROR, "Failed to open font face '%s'.", file_name.c_str());
+		return false;
+	}
+
+	std::vector<byte> data(file_interface->Length(file));
+	file_interface->Read(data.data(), data.size(), file);
+	file_interface->Close(file);
+
+	const String family = font_family_name(data.data(), data.size());
+	if (family.empty()) {
+		Log::Message(Log::LT_ERROR, "Font face '%s' has no family name.", file_name.c_str());
+		return false;
+	}
+
+	return LoadFace(data.data(), data.size(), family, Style::FontStyle::Normal, weight, fallback_face);
+}
+
+bool SdfFontEngine::LoadFontFace(const byte *data, int data_size, const String &family, Style::FontStyle style,
+								 Style::FontWeight weight, bool fallback_face)
+{
+	if (!family.empty()) return LoadFace(data, data_size, family, style, weight, fallback_face);
+
+	const String name = font_family_name(data, data_size);
+	if (name.empty()) {
+		Log::Message(Log::LT_ERROR, "Font face has no family name.");
+		return false;
+	}
+	return LoadFace(data, data_size, name, style, weight, fallback_face);
+}
+
+bool SdfFontEngine::LoadFace(const byte *data, size_t size, const String &family, Style::FontStyle style,
+							 Style::FontWeight weight, bool fallback)
+{
+	auto face		= std::make_unique<Face>();
+	face->family	= to_lower(family);
+	face->style		= style;
+	face->weight	= weight == Style::FontWeight::Auto ? Style::FontWeight::Normal : weight;
+	face->fallback	= fallback;
+	face->base_size = base_size;
+
+	// Keyed by content, a changed font file gets a new atlas.
+	const String path = CreateString(128, "cache/fonts/%016llx-%d", static_cast<unsigned long long>(fnv1a(data, size)), base_size);
+
+	if (!LoadAtlas(*face, path) && !BakeAtlas(*face, data, size, path)) return false;
+
+	if (face->pixels.empty()) {
+		face->texture.Set(path + ".sdf.png");
+	} else {
+		const Face *baked = face.get();
+		face->texture.Set(path + ".sdf.png", [this, baked](RenderInterface *render_interface, const String &, TextureHandle &handle, Vector2i &dimensions) {
+			dimensions = Vector2i(baked->atlas_width, baked->atlas_height);
+			return atlas_upload ? atlas_upload(handle, baked->pixels.data(), dimensions)
+								: render_interface->GenerateTexture(handle, baked->pixels.data(), dimensions);
+		});
+	}
+	faces.push_back(std::move(face));
+	return true;
+}
+
+bool SdfFontEngine::LoadAtlas(Face &face, const String &path)
+{
+	if (!PHYSFS_exists((path + ".sdf.png").c_str())) return false;
+
+	PHYSFS_File *file = PHYSFS_openRead((path + ".sdf.bin").c_str());
+	if (!file) return false;
+
+	AtlasHeader header;
+	bool		valid = PHYSFS_readBytes(file, &header, sizeof(header)) == sizeof(header)
+				 && header.magic == AtlasMagic
+				 && header.version == AtlasVersion
+				 && header.base_size == face.base_size
+				 && header.glyph_count > 0;
+
+	for (int i = 0; valid && i < header.glyph_count; i++) {
+		AtlasGlyph glyph;
+		valid = PHYSFS_readBytes(file, &glyph, sizeof(glyph)) == sizeof(glyph);
+		face.glyphs[static_cast<Character>(glyph.codepoint)] = {glyph.advance, glyph.offset_x, glyph.offset_y,
+																 glyph.x, glyph.y, glyph.width, glyph.height};
+	}
+	PHYSFS_close(file);
+
+	if (!valid) {
+		face.glyphs.clear();
+		return false;
+	}
+
+	face.atlas_width  = header.atlas_width;
+	face.atlas_height = header.atlas_height;
+	face.baseline	  = header.baseline;
+	face.x_height	  = header.x_height;
+	return true;
+}
+
+bool SdfFontEngine::BakeAtlas(Face &face, const byte *data, size_t size, const String &path)
+{
+	// Basic Latin and Latin-1 Supplement.
+	std::vector<int> codepoints;
+	for (int c = 32; c < 127; c++) codepoints.push_back(c);
+	for (int c = 160; c < 256; c++) codepoints.push_back(c);
+	const int count = static_cast<int>(codepoints.size());
+
+	GlyphInfo *glyphs = LoadFontData(data, static_cast<int>(size), face.base_size, codepoints.data(), count, FONT_SDF);
+	if (!glyphs) {
+		Log::Message(Log::LT_ERROR, "Failed to rasterize font face '%s'.", face.family.c_str());
+		return false;
+	}
+
+	Rectangle *recs	 = nullptr;
+	Image	   atlas = GenImageFontAtlas(glyphs, &recs, count, face.base_size, 2, 0);
+
+	std::vector<AtlasGlyph> records;
+	for (int i = 0; i < count; i++) {
+		records.push_back({static_cast<uint32_t>(glyphs[i].value), static_cast<float>(glyphs[i].advanceX),
+						   static_cast<float>(glyphs[i].offsetX), static_cast<float>(glyphs[i].offsetY),
+						   recs[i].x, recs[i].y, recs[i].width, recs[i].height});
+		face.glyphs[static_cast<Character>(glyphs[i].value)] = {records.back().advance, records.back().offset_x, records.back().offset_y,
+																 recs[i].x, recs[i].y, recs[i].width, recs[i].height};
+	}
+
+	face.atlas_width  = atlas.width;
+	face.atlas_height = atlas.height;
+
+	// Glyph images include the SDF padding: 'H' sits on the baseline, 'x' spans the x-height.
+	const Glyph *capital = FindGlyph(face, static_cast<Character>('H'));
+	const Glyph *small	 = FindGlyph(face, static_cast<Character>('x'));
+	face.baseline		 = capital ? capital->offset_y + capital->height - SdfPadding : face.base_size * 0.8f;
+	face.x_height		 = small ? face.baseline - (small->offset_y + SdfPadding) : face.base_size * 0.5f;
+
+	AtlasHeader header{AtlasMagic, AtlasVersion, face.base_size, atlas.width, atlas.height, count, face.baseline, face.x_height};
+
+	bool saved = ExportImage(atlas, (path + ".sdf.png").c_str());
+	if (saved) {
+		PHYSFS_File *file = PHYSFS_openWrite((path + ".sdf.bin").c_str());
+		saved			  = file
+				&& PHYSFS_writeBytes(file, &header, sizeof(header)) == sizeof(header)
+				&& PHYSFS_writeBytes(file, records.data(), records.size() * sizeof(AtlasGlyph)) == static_cast<PHYSFS_sint64>(records.size() * sizeof(AtlasGlyph));
+		if (file) PHYSFS_close(file);
+	}
+
+	// The cache only saves the next launch the rasterization, without it
+	// the atlas is uploaded from memory.
+	if (!saved) {
+		Log::Message(Log::LT_WARNING, "Failed to cache font atlas '%s', is the write directory set?", path.c_str());
+		ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+		const auto *pixels = static_cast<const byte *>(atlas.data);
+		face.pixels.assign(pixels, pixels + static_cast<size_t>(atlas.width) * atlas.height * 4);
+	}
+
+	UnloadImage(atlas);
+	MemFree(recs);
+	UnloadFontData(glyphs, count);
+
+	Log::Message(Log::LT_INFO, "Baked SDF atlas for '%s' (%dx%d).", face.family.c_str(), face.atlas_width, face.atlas_height);
+	return true;
+}
+
+const SdfFontEngine::Glyph *SdfFontEngine::FindGlyph(const Face &face, Character character) const
+{
+	auto it = face.glyphs.find(character);
+	if (it == face.glyphs.end()) it = face.glyphs.find(static_cast<Character>('?'));
+	return it == face.glyphs.end() ? nullptr : &it->second;
+}
+
+FontFaceHandle SdfFontEngine::GetFontFaceHandle(const String &family, Style::FontStyle style, Style::FontWeight weight, int size)
+{
+	const String name = to_lower(family);
+	if (weight == Style::FontWeight::Auto) weight = Style::FontWeight::Normal;
+
+	Face *match = nullptr;
+	for (auto &face : faces) {
+		if (face->family != name) continue;
+		if (face->style == style && face->weight == weight) {
+			match = face.get();
+			break;
+		}
+		if (!match) match = face.get();
+	}
+	if (!match) {
+		for (auto &face : faces)
+			if (face->fallback) {
+				match = face.get();
+				break;
+			}
+	}
+	if (!match) return 0;
+
+	for (auto &sized : sized_faces)
+		if (sized->face == match && sized->size == size) return reinterpret_cast<FontFaceHandle>(sized.get());
+
+	sized_faces.push_back(std::make_unique<SizedFace>(SizedFace{match, size, static_cast<float>(size) / match->base_size}));
+	return reinterpret_cast<FontFaceHandle>(sized_faces.back().get());
+}
+
+FontEffectsHandle SdfFontEngine::PrepareFontEffects(FontFaceHandle, const FontEffectList &)
+{
+	return 0;
+}
+
+int SdfFontEngine::GetSize(FontFaceHandle handle)
+{
+	return reinterpret_cast<SizedFace *>(handle)->size;
+}
+
+int SdfFontEngine::GetXHeight(FontFaceHandle handle)
+{
+	auto sized = reinterpret_cast<SizedFace *>(handle);
+	return Math::RoundToInteger(sized->face->x_height * sized->scale);
+}
+
+int SdfFontEngine::GetLineHeight(FontFaceHandle handle)
+{
+	return reinterpret_cast<SizedFace *>(handle)->size;
+}
+
+int SdfFontEngine::GetBaseline(FontFaceHandle handle)
+{
+	// Distance from the bottom of the line box up to the baseline.
+	auto sized = reinterpret_cast<SizedFace *>(handle);
+	return sized->size - Math::RoundToInteger(sized->face->baseline * sized->scale);
+}
+
+float SdfFontEngine::GetUnderline(FontFaceHandle handle, float &thickness)
+{
+	auto sized = reinterpret_cast<SizedFace *>(handle);
+	thickness  = std::max(1.0f, sized->size / 16.0f);
+	return -sized->size / 10.0f;
+}
+
+int SdfFontEngine::GetStringWidth(FontFaceHandle handle, const String &string, Character)
+{
+	auto  sized = reinterpret_cast<SizedFace *>(handle);
+	float width = 0;
+	for (auto it = StringIteratorU8(string); it; ++it)
+		if (const Glyph *glyph = FindGlyph(*sized->face, *it)) width += glyph->advance;
+	return Math::RoundToInteger(width * sized->scale);
+}
+
+int SdfFontEngine::GenerateString(FontFaceHandle face_handle, FontEffectsHandle, const String &string,
+								  const Vector2f &position, const Colourb &colour, float opacity, GeometryList &geometry)
+{
+	auto		sized = reinterpret_cast<SizedFace *>(face_handle);
+	const Face &face  = *sized->face;
+
+	geometry.emplace_back();
+	Geometry &text = geometry.back();
+	text.SetTexture(&face.texture);
+
+	auto &vertices = text.GetVertices();
+	auto &indices  = text.GetIndices();
+	vertices.reserve(string.size() * 4);
+	indices.reserve(string.size() * 6);
+
+	Colourb text_colour = colour;
+	text_colour.alpha	= static_cast<byte>(opacity * colour.alpha);
+
+	const float top = position.y - face.baseline * sized->scale;
+	float		x	= position.x;
+
+	for (auto it = StringIteratorU8(string); it; ++it) {
+		const Glyph *glyph = FindGlyph(face, *it);
+		if (!glyph) continue;
+
+		if (glyph->width > 0 && glyph->height > 0) {
+			const int offset = static_cast<int>(vertices.size());
+			vertices.resize(offset + 4);
+			indices.resize(indices.size() + 6);
+
+			GeometryUtilities::GenerateQuad(&vertices[offset], &indices[indices.size() - 6],
+											Vector2f(x + glyph->offset_x * sized->scale, top + glyph->offset_y * sized->scale),
+											Vector2f(glyph->width * sized->scale, glyph->height * sized->scale),
+											text_colour,
+											Vector2f(glyph->x / face.atlas_width, glyph->y / face.atlas_height),
+											Vector2f((glyph->x + glyph->width) / face.atlas_width, (glyph->y + glyph->height) / face.atlas_height),
+											offset);
+		}
+
+		x += glyph->advance * sized->scale;
+	}
+
+	return Math::RoundToInteger(x - position.x);
+}
+
+int SdfFontEngine::GetVersion(FontFaceHandle)
+{
+	// The atlas holds every glyph up front and never changes.
+	return 1;
+}
+
+void SdfFontEngine::ReleaseFontResources()
+{
+	sized_faces.clear();
+	faces.clear();
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <RmlUi/Core.h>
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// RmlUi font engine serving every font size from a single signed distance
+// field atlas per face.
+//
+// Glyphs are rasterized once with raylib's SDF font loader at a base size and
+// the atlas is persisted to the write directory (cache/fonts), so later
+// launches skip rasterization. Without a writable cache the atlas is kept in
+// memory and uploaded from there. Textures ending in ".sdf.png" are drawn
+// with the SDF shader by GameRenderInterface. Font effects are not supported.
+class SdfFontEngine : public Rml::FontEngineInterface
+{
+   public:
+	SdfFontEngine(int base_size = 48);
+	virtual ~SdfFontEngine();
+
+	// Uploads an RGBA atlas kept in memory. Without one, atlases go through
+	// RenderInterface::GenerateTexture(), which knows nothing of SDF.
+	using AtlasUpload = std::function<bool(Rml::TextureHandle &handle, const Rml::byte *rgba, const Rml::Vector2i &dimensions)>;
+	void SetAtlasUpload(AtlasUpload upload) { atlas_upload = std::move(upload); }
+
+	bool LoadFontFace(const Rml::String &file_name, bool fallback_face, Rml::Style::FontWeight weight) override;
+	// An empty family is read from the font's name table.
+	bool LoadFontFace(const Rml::byte *data, int data_size, const Rml::String &family, Rml::Style::FontStyle style,
+					  Rml::Style::FontWeight weight, bool fallback_face) override;
+
+	Rml::FontFaceHandle GetFontFaceHandle(const Rml::String &family, Rml::Style::FontStyle style,
+										  Rml::Style::FontWeight weight, int size) override;
+
+	Rml::FontEffectsHandle PrepareFontEffects(Rml::FontFaceHandle handle, const Rml::FontEffectList &font_effects) override;
+
+	int	  GetSize(Rml::FontFaceHandle handle) override;
+	int	  GetXHeight(Rml::FontFaceHandle handle) override;
+	int	  GetLineHeight(Rml::FontFaceHandle handle) override;
+	int	  GetBaseline(Rml::FontFaceHandle handle) override;
+	float GetUnderline(Rml::FontFaceHandle handle, float &thickness) override;
+	int	  GetStringWidth(Rml::FontFaceHandle handle, const Rml::String &string, Rml::Character prior_character) override;
+
+	int GenerateString(Rml::FontFaceHandle face_handle, Rml::FontEffectsHandle font_effects_handle, const Rml::String &string,
+					   const Rml::Vector2f &position, const Rml::Colourb &colour, float opacity, Rml::GeometryList &geometry) override;
+
+	int	 GetVersion(Rml::FontFaceHandle handle) override;
+	void ReleaseFontResources() override;
+
+   private:
+	struct Glyph
+	{
+		float advance;
+		float offset_x, offset_y;  // from the top-left of the line box, at base size
+		float x, y, width, height;	// atlas rectangle
+	};
+
+	struct Face
+	{
+		Rml::String										family;
+		Rml::Style::FontStyle							style;
+		Rml::Style::FontWeight							weight;
+		bool											fallback;
+		int												base_size;
+		int												atlas_width, atlas_height;
+		float											baseline;  // from the top of the line box, at base size
+		float											x_height;
+		std::unordered_map<Rml::Character, Glyph>		glyphs;
+		Rml::Texture									texture;
+		std::vector<Rml::byte>							pixels;	 // RGBA atlas, when it could not be cached
+	};
+
+	struct SizedFace
+	{
+		Face *face;
+		int	  size;
+		float scale;
+	};
+
+	int										base_size;
+	AtlasUpload								atlas_upload;
+	std::vector<std::unique_ptr<Face>>		faces;
+	std::vector<std::unique_ptr<SizedFace>> sized_faces;
+
+	bool		 LoadFace(const Rml::byte *data, size_t size, const Rml::String &family, Rml::Style::FontStyle style,
+						  Rml::Style::FontWeight weight, bool fallback);
+	bool		 LoadAtlas(Face &face, const Rml::String &path);
+	bool		 BakeAtlas(Face &face, const Rml::byte *data, size_t size, const Rml::String &path);
+	const Glyph *FindGlyph(const Face &face, Rml::Character character) const;
+};
@@ -0,0 +1,307 @@
+#include "sprite_batch.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "raymath.h"
+#include "rlgl.h"
+
+// --- Sprite Batch --------------------------------------------------------
+
+static const char *sprite_vertex_shader = R"(#version 330
+layout(location = 0) in vec2 vertexPosition;
+layout(location = 1) in vec4 instanceRect;
+layout(location = 2) in vec4 instanceSource;
+layout(location = 3) in vec4 instanceTint;
+
+uniform mat4 mvp;
+
+out vec2 fragTexCoord;
+out vec4 fragColor;
+
+void main()
+{
+	fragTexCoord = mix(instanceSource.xy, instanceSource.zw, vertexPosition);
+	fragColor = instanceTint;
+	gl_Position = mvp*vec4(instanceRect.xy + vertexPosition*instanceRect.zw, 0.0, 1.0);
+}
+)";
+
+static const char *sprite_fragment_shader = R"(#version 330
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;
+
+out vec4 finalColor;
+
+void main()
+{
+	finalColor = texture(texture0, fragTexCoord)*fragColor;
+}
+)";
+
+// Two triangles over the unit square.
+static const float unit_quad[] = {0, 0, 0, 1, 1, 1, 0, 0, 1, 1, 1, 0};
+
+SpriteBatch::SpriteBatch(int capacity)
+	: draw_calls{0},
+	  loaded{false},
+	  shader{},
+	  mvp_location{-1},
+	  texture_location{-1},
+	  vertex_array{0},
+	  quad_buffer{0},
+	  instance_buffer{0},
+	  capacity{0},
+	  initial_capacity{capacity}
+{
+}
+
+SpriteBatch::~SpriteBatch()
+{
+	if (instance_buffer) rlUnloadVertexBuffer(instance_buffer);
+	if (quad_buffer) rlUnloadVertexBuffer(quad_buffer);
+	if (vertex_array) rlUnloadVertexArray(vertex_array);
+	if (shader.id) UnloadShader(shader);
+}
+
+void SpriteBatch::Load()
+{
+	loaded = true;
+	if (rlGetVersion() != RL_OPENGL_33 && rlGetVersion() != RL_OPENGL_43) return;
+
+	// Falls back to the default shader when compilation fails.
+	shader = LoadShaderFromMemory(sprite_vertex_shader, sprite_fragment_shader);
+	if (shader.id == rlGetShaderIdDefault()) {
+		shader = {};
+		return;
+	}
+	vertex_array = rlLoadVertexArray();
+	if (!vertex_array) {
+		UnloadShader(shader);
+		shader = {};
+		return;
+	}
+
+	mvp_location	 = GetShaderLocation(shader, "mvp");
+	texture_location = GetShaderLocation(shader, "texture0");
+
+	rlEnableVertexArray(vertex_array);
+	quad_buffer = rlLoadVertexBuffer(unit_quad, sizeof(unit_quad), false);
+	rlSetVertexAttribute(0, 2, RL_FLOAT, false, 0, nullptr);
+	rlEnableVertexAttribute(0);
+	rlDisableVertexArray();
+
+	Reserve(initial_capacity);
+}
+
+void SpriteBatch::Reserve(int count)
+{
+	if (count <= capacity) return;
+	capacity = std::max(count, capacity * 2);
+
+	rlEnableVertexArray(vertex_array);
+	if (instance_buffer) rlUnloadVertexBuffer(instance_buffer);
+	instance_buffer = rlLoadVertexBuffer(nullptr, capacity * sizeof(SpriteInstance), true);
+	SetInstanceAttributes(0);
+	for (int index = 1; index <= 3; index++) {
+		rlEnableVertexAttribute(index);
+		rlSetVertexAttributeDivisor(index, 1);
+	}
+	rlDisableVertexArray();
+}
+
+// Points the instance attributes at instance `first`. There is no base
+// instance in OpenGL 3.3, every run starts where its attributes point.
+void SpriteBatch::SetInstanceAttributes(int first)
+{
+	const auto base = reinterpret_cast<const char *>(static_cast<size_t>(first) * sizeof(SpriteInstance));
+	rlEnableVertexBuffer(instance_buffer);
+	rlSetVertexAttribute(1, 4, RL_FLOAT, false, sizeof(SpriteInstance), base + offsetof(SpriteInstance, x));
+	rlSetVertexAttribute(2, 4, RL_FLOAT, false, sizeof(SpriteInstance), base + offsetof(SpriteInstance, u0));
+	rlSetVertexAttribute(3, 4, RL_UNSIGNED_BYTE, true, sizeof(SpriteInstance), base + offsetof(SpriteInstance, tint));
+}
+
+void SpriteBatch::Begin()
+{
+	queued.clear();
+	draw_calls = 0;
+}
+
+void SpriteBatch::Draw(const Sprite &sprite)
+{
+	queued.push_back(sprite);
+}
+
+void SpriteBatch::Prepare()
+{
+	// Layer biased to sort negative ones first, the queue index keeps the
+	// sort stable.
+	keys.resize(queued.size());
+	for (size_t index = 0; index < queued.size(); index++) {
+		const auto layer = static_cast<uint64_t>(static_cast<uint16_t>(queued[index].layer + 0x8000));
+		keys[index]		 = layer << 48 | static_cast<uint64_t>(queued[index].texture.id & 0xffff) << 32 | index;
+	}
+	std::sort(keys.begin(), keys.end());
+
+	instances.resize(queued.size());
+	runs.clear();
+	for (size_t index = 0; index < keys.size(); index++) {
+		const Sprite &sprite   = queued[static_cast<uint32_t>(keys[index])];
+		auto		 &instance = instances[index];
+
+		const float texture_width  = static_cast<float>(sprite.texture.width);
+		const float texture_height = static_cast<float>(sprite.texture.height);
+		instance.x				   = sprite.dest.x;
+		instance.y				   = sprite.dest.y;
+		instance.width			   = sprite.dest.width;
+		instance.height			   = sprite.dest.height;
+		instance.u0				   = sprite.source.x / texture_width;
+		instance.v0				   = sprite.source.y / texture_height;
+		instance.u1				   = (sprite.source.x + sprite.source.width) / texture_width;
+		instance.v1				   = (sprite.source.y + sprite.source.height) / texture_height;
+		instance.tint[0]		   = sprite.tint.r;
+		instance.tint[1]		   = sprite.tint.g;
+		instance.tint[2]		   = sprite.tint.b;
+		instance.tint[3]		   = sprite.tint.a;
+
+		if (runs.empty() || runs.back().texture_id != sprite.texture.id)
+			runs.push_back({sprite.texture.id, static_cast<int>(index), 1});
+		else
+			runs.back().count++;
+	}
+}
+
+void SpriteBatch::End()
+{
+	Prepare();
+	if (instances.empty()) return;
+	if (!loaded) Load();
+
+	// Keep ordering against immediate mode draws issued before the batch.
+	rlDrawRenderBatchActive();
+
+	if (IsInstanced())
+		FlushInstanced();
+	else
+		FlushImmediate();
+}
+
+void SpriteBatch::FlushInstanced()
+{
+	Reserve(static_cast<int>(instances.size()));
+	rlUpdateVertexBuffer(instance_buffer, instances.data(), instances.size() * sizeof(SpriteInstance), 0);
+
+	const Matrix mvp
+		= MatrixMultiply(MatrixMultiply(rlGetMatrixTransform(), rlGetMatrixModelview()), rlGetMatrixProjection());
+	const int texture_slot = 0;
+
+	rlEnableShader(shader.id);
+	rlSetUniformMatrix(mvp_location, mvp);
+	rlSetUniform(texture_location, &texture_slot, RL_SHADER_UNIFORM_INT, 1);
+	rlActiveTextureSlot(texture_slot);
+	rlEnableVertexArray(vertex_array);
+
+	for (const auto &run : runs) {
+		rlEnableTexture(run.texture_id);
+		SetInstanceAttributes(run.first);
+		rlDrawVertexArrayInstanced(0, 6, run.count);
+		draw_calls++;
+	}
+
+	rlDisableVertexArray();
+	rlDisableVertexBuffer();
+	rlDisableTexture();
+	rlDisableShader();
+}
+
+void SpriteBatch::FlushImmediate()
+{
+	for (const auto &run : runs) {
+		rlSetTexture(run.texture_id);
+		rlBegin(RL_QUADS);
+		for (int index = run.first; index < run.first + run.count; index++) {
+			const auto &instance = instances[index];
+			const float right	 = instance.x + instance.width;
+			const float bottom	 = instance.y + instance.height;
+
+			rlColor4ub(instance.tint[0], instance.tint[1], instance.tint[2], instance.tint[3]);
+			rlTexCoord2f(instance.u0, instance.v0);
+			rlVertex2f(instance.x, instance.y);
+			rlTexCoord2f(instance.u0, instance.v1);
+			rlVertex2f(instance.x, bottom);
+			rlTexCoord2f(instance.u1, instance.v1);
+			rlVertex2f(right, bottom);
+			rlTexCoord2f(instance.u1, instance.v0);
+			rlVertex2f(right, instance.y);
+		}
+		rlEnd();
+		draw_calls++;
+	}
+	rlSetTexture(0);
+	rlDrawRenderBatchActive();
+}
+
+// --- Sprite Set ----------------------------------------------------------
+
+static GridRect grid_rect(Rectangle rect)
+{
+	return {rect.x, rect.y, rect.width, rect.height};
+}
+
+int SpriteSet::Add(const Sprite &sprite)
+{
+	int id;
+	if (!free_ids.empty()) {
+		id = free_ids.back();
+		free_ids.pop_back();
+		sprites[id] = sprite;
+	}
+	else {
+		id = static_cast<int>(sprites.size());
+		sprites.push_back(sprite);
+	}
+	grid.Insert(id, grid_rect(sprite.dest));
+	return id;
+}
+
+void SpriteSet::Move(int id, Rectangle dest)
+{
+	sprites[id].dest = dest;
+	grid.Update(id, grid_rect(dest));
+}
+
+void SpriteSet::Remove(int id)
+{
+	grid.Remove(id);
+	free_ids.push_back(id);
+}
+
+int SpriteSet::Draw(SpriteBatch &batch, Rectangle view)
+{
+	visible.clear();
+	grid.Query(grid_rect(view), visible);
+	for (int id : visible) batch.Draw(sprites[id]);
+	return static_cast<int>(visible.size());
+}
+
+Rectangle camera_view(const Camera2D &camera, int width, int height)
+{
+	// Bounds of the four corners, the camera may be rotated.
+	const Vector2 corners[] = {
+		GetScreenToWorld2D({0, 0}, camera),
+		GetScreenToWorld2D({static_cast<float>(width), 0}, camera),
+		GetScreenToWorld2D({0, static_cast<float>(height)}, camera),
+		GetScreenToWorld2D({static_cast<float>(width), static_cast<float>(height)}, camera),
+	};
+
+	Vector2 min = corners[0], max = corners[0];
+	for (const auto &corner : corners) {
+		min.x = std::min(min.x, corner.x);
+		min.y = std::min(min.y, corner.y);
+		max.x = std::max(max.x, corner.x);
+		max.y = std::max(max.y, corner.y);
+	}
+	return {min.x, min.y, max.x - min.x, max.y - min.y};
+}
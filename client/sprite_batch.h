@@ -0,0 +1,120 @@
+#pragma once
+
+#include <raylib-cpp.hpp>
+#include <vector>
+
+#include "spatial_grid.h"
+
+struct Sprite
+{
+	Texture2D texture;
+	Rectangle source;  // in texels
+	Rectangle dest;	   // in world units
+	Color	  tint;
+	int		  layer;  // lower layers are drawn first
+};
+
+// Per-instance vertex data, one unit quad is expanded per sprite in the
+// vertex shader.
+struct SpriteInstance
+{
+	float		  x, y, width, height;
+	float		  u0, v0, u1, v1;
+	unsigned char tint[4];
+};
+
+// Draws many sprites in a few calls.
+//
+// Sprites queued between Begin() and End() are sorted by layer and texture,
+// keeping submission order within a layer and texture, and packed into a
+// persistent instance buffer: every run of one texture is a single instanced
+// draw. Without OpenGL 3.3 the runs go through the rlgl batch instead, still
+// with one texture switch per run.
+//
+// GPU resources are created by the first End(), with a window open.
+// End() draws with the current rlgl transform, inside BeginMode2D() that is
+// the camera. Immediate mode draws queued before it are flushed first, so
+// ordering against them is kept.
+class SpriteBatch
+{
+   public:
+	explicit SpriteBatch(int capacity = 4096);
+	~SpriteBatch();
+
+	SpriteBatch(const SpriteBatch &)			= delete;
+	SpriteBatch &operator=(const SpriteBatch &) = delete;
+
+	void Begin();
+	void Draw(const Sprite &sprite);
+	void End();
+
+	// The CPU half of End(): sorts the queued sprites and packs the instances.
+	// Split out to measure it without a window.
+	void Prepare();
+
+	int GetSprites() const { return static_cast<int>(instances.size()); }
+	int GetRuns() const { return static_cast<int>(runs.size()); }
+	int GetDrawCalls() const { return draw_calls; }
+
+	// Whether runs are drawn instanced, known after the first End().
+	bool IsInstanced() const { return shader.id != 0; }
+
+	const std::vector<SpriteInstance> &GetInstances() const { return instances; }
+
+   private:
+	struct Run
+	{
+		unsigned int texture_id;
+		int			 first, count;
+	};
+
+	std::vector<Sprite>			queued;
+	std::vector<uint64_t>		keys;  // layer, texture id, queue index
+	std::vector<SpriteInstance> instances;
+	std::vector<Run>			runs;
+	int							draw_calls;
+
+	bool		 loaded;
+	Shader		 shader;
+	int			 mvp_location;
+	int			 texture_location;
+	unsigned int vertex_array;
+	unsigned int quad_buffer;
+	unsigned int instance_buffer;
+	int			 capacity;	// instances the instance buffer holds
+	int			 initial_capacity;
+
+	void Load();
+	void Reserve(int count);
+	void SetInstanceAttributes(int first);
+	void FlushInstanced();
+	void FlushImmediate();
+};
+
+// Sprites kept in a spatial grid, drawn by querying the camera view, so
+// only the visible part of a large world reaches the batch.
+class SpriteSet
+{
+   public:
+	explicit SpriteSet(float cell_size = 256.0f) : grid{cell_size} {}
+
+	int	 Add(const Sprite &sprite);
+	void Move(int id, Rectangle dest);
+	void Remove(int id);
+
+	Sprite &Get(int id) { return sprites[id]; }
+
+	// Queues the sprites overlapping `view` into the batch, returns their count.
+	int Draw(SpriteBatch &batch, Rectangle view);
+
+	int GetCount() const { return grid.GetCount(); }
+
+   private:
+	std::vector<Sprite> sprites;  // by id
+	std::vector<int>	free_ids;
+	std::vector<int>	visible;
+	SpatialGrid			grid;
+};
+
+// World space area seen through `camera` on a `width` x `height` screen.
+Rectangle camera_view(const Camera2D &camera, int width, int height);
@@ -0,0 +1,152 @@
+#include "game_server.h"
+
+#include <chrono>
+#include <inttypes.h>
+
+using namespace yojimbo;
+
+static ClientTable::Config MakeClientTableConfig( const GameServer::Config & config )
+{
+    ClientTable::Config clientConfig;
+    clientConfig.capacity = config.maxClients;
+    clientConfig.idle_timeout = config.idleTimeout;
+    return clientConfig;
+}
+
+GameServer::GameServer( Allocator & allocator, const uint8_t privateKey[], const Address & address,
+    const ClientServerConfig & connectionConfig, const Config & config, double time )
+    : config( config ),
+      time( time ),
+      server( allocator, privateKey, address, connectionConfig, adapter, time ),
+      numChannels( connectionConfig.numChannels ),
+      scheduler( config.maxClients ),
+      clients( MakeClientTableConfig( config ) ),
+      packetsReceived( config.maxClients, 0 ),
+      checkpointer( config.checkpoint ),
+      tickCount( 0 ),
+      tickOverruns( 0 )
+{
+    tickSamples.reserve( config.tickWindow );
+
+    compressor.SetChannelEnabled( ReliableChannel, true );
+
+    sendMessage = [this]( int clientIndex, const OutgoingMessage & outgoing )
+    {
+        if ( !server.CanSendMessage( clientIndex, outgoing.channel ) )
+            return false;
+        server.SendMessage( clientIndex, outgoing.channel, (Message*) outgoing.message );
+        return true;
+    };
+
+    releaseMessage = [this]( int clientIndex, const OutgoingMessage & outgoing )
+    {
+        server.ReleaseMessage( clientIndex, (Message*) outgoing.message );
+    };
+
+    adapter.onClientConnected = [this]( int clientIndex )
+    {
+        scheduler.Clear( clientIndex, releaseMessage );
+        packetsReceived[clientIndex] = 0;
+
+        // An untracked client would never be drained, scheduled or timed out.
+        const uint64_t clientId = server.GetClientId( clientIndex );
+        if ( !clients.Connect( clientIndex, clientId, 0, this->time ) )
+        {
+            printf( "client %d (%.16" PRIx64 ") rejected by the client table, disconnecting\n", clientIndex, clientId );
+            server.DisconnectClient( clientIndex );
+        }
+    };
+
+    adapter.onClientDisconnected = [this]( int clientIndex )
+    {
+        scheduler.Clear( clientIndex, releaseMessage );
+        clients.Disconnect( clientIndex );
+    };
+}
+
+void GameServer::Start()
+{
+    Checkpointer::RestoreInfo restored;
+    if ( config.checkpoints && checkpointer.Restore( world, &restored ) )
+    {
+        printf( "restored %d entities at tick %" PRIu64 " from checkpoint generation %u + %d deltas in %.2f ms\n",
+            world.GetCount(), restored.tick, restored.generation, restored.deltas, restored.ms );
+    }
+
+    server.Start( config.maxClients );
+}
+
+void GameServer::Tick( double deltaTime )
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    for ( int i : clients.GetActive() )
+    {
+        for ( int channel = 0; channel < numChannels; ++channel )
+        {
+            while ( Message * message = server.ReceiveMessage( i, channel ) )
+            {
+                if ( onMessage )
+                    onMessage( i, channel, message );
+                server.ReleaseMessage( i, message );
+            }
+        }
+
+        // Any packet counts as activity, keep-alives included: the client
+        // only sends game messages when it has something to say.
+        NetworkInfo info;
+        server.GetNetworkInfo( i, info );
+        if ( info.numPacketsReceived != packetsReceived[i] )
+        {
+            packetsReceived[i] = info.numPacketsReceived;
+            clients.Touch( i, time );
+        }
+
+        scheduler.Update( i, LinkStats{ info.RTT, info.packetLoss, info.sentBandwidth, info.ackedBandwidth }, time, deltaTime );
+        scheduler.Flush( i, sendMessage );
+    }
+
+    clients.ExpireTimeouts( time, [this]( int clientIndex )
+    {
+        printf( "client %d idle, disconnecting\n", clientIndex );
+        server.DisconnectClient( clientIndex );
+    } );
+
+    world.Step( Fixed::FromFloat( (float) deltaTime ) );
+    if ( config.checkpoints )
+        checkpointer.Update( world, time );
+
+    server.SendPackets();
+
+    server.ReceivePackets();
+
+    time += deltaTime;
+
+    server.AdvanceTime( time );
+
+    const double ms = std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+    if ( (int) tickSamples.size() < config.tickWindow )
+        tickSamples.push_back( ms );
+    else if ( config.tickWindow > 0 )
+        tickSamples[tickCount % config.tickWindow] = ms;
+    if ( ms > deltaTime * 1000.0 )
+        ++tickOverruns;
+    ++tickCount;
+}
+
+Percentiles GameServer::GetTickPercentiles() const
+{
+    std::vector<double> samples = tickSamples;
+    return compute_percentiles( samples );
+}
+
+void GameServer::Stop()
+{
+    for ( int i = 0; i < config.maxClients; ++i )
+        scheduler.Clear( i, releaseMessage );
+
+    server.Stop();
+
+    if ( config.checkpoints && !checkpointer.Flush( world ) )
+        printf( "error: final checkpoint not written\n" );
+}
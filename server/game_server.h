@@ -0,0 +1,128 @@
+#pragma once
+
+#include "yojimbo.h"
+#include "shared.h"
+#include "checkpoint.h"
+#include "client_table.h"
+#include "block_compression.h"
+#include "entity_store.h"
+#include "send_scheduler.h"
+#include "stats.h"
+
+#include <functional>
+#include <vector>
+
+// Channel layout of the default ClientServerConfig.
+enum GameChannel
+{
+    ReliableChannel,
+    UnreliableChannel,
+};
+
+// Forwards yojimbo's connection callbacks, so connected clients are tracked
+// as they come and go instead of by polling every slot.
+class ServerAdapter : public TestAdapter
+{
+public:
+    std::function<void( int )> onClientConnected;
+    std::function<void( int )> onClientDisconnected;
+
+    void OnServerClientConnected( int clientIndex ) override
+    {
+        if ( onClientConnected )
+            onClientConnected( clientIndex );
+    }
+
+    void OnServerClientDisconnected( int clientIndex ) override
+    {
+        if ( onClientDisconnected )
+            onClientDisconnected( clientIndex );
+    }
+};
+
+// The server's simulation tick: yojimbo transport, connected clients, the
+// send scheduler, the world and its checkpoints. The server executable
+// drives it in real time, the benchmarks as fast as it goes.
+class GameServer
+{
+public:
+    struct Config
+    {
+        int maxClients = MaxClients;
+        double idleTimeout = 300.0;             // clients without a packet for this long are disconnected
+        bool checkpoints = true;                // restore the world at Start(), checkpoint it while running
+        int tickWindow = 1000;                  // ticks kept for the duration percentiles
+        Checkpointer::Config checkpoint;
+    };
+
+    GameServer( yojimbo::Allocator & allocator, const uint8_t privateKey[], const yojimbo::Address & address,
+        const yojimbo::ClientServerConfig & connectionConfig, const Config & config, double time );
+
+    // Restores the world from the latest checkpoint, then starts listening.
+    void Start();
+
+    // Receives, simulates and sends one tick of deltaTime seconds, then
+    // advances the time by it.
+    void Tick( double deltaTime );
+
+    // Disconnects everyone and writes a final checkpoint.
+    void Stop();
+
+    // Game messages received in Tick(), released once it returns.
+    std::function<void( int clientIndex, int channel, yojimbo::Message * message )> onMessage;
+
+    bool IsRunning() const { return server.IsRunning(); }
+    double GetTime() const { return time; }
+
+    // Wall clock duration of the last ticks, in milliseconds, and how many
+    // ticks since the start took longer than their deltaTime.
+    Percentiles GetTickPercentiles() const;
+    int GetTickSampleCount() const { return (int) tickSamples.size(); }
+    uint64_t GetTickCount() const { return tickCount; }
+    uint64_t GetTickOverruns() const { return tickOverruns; }
+
+    yojimbo::Server & GetServer() { return server; }
+    const ClientTable & GetClients() const { return clients; }
+    const SendScheduler & GetScheduler() const { return scheduler; }
+    EntityStore & GetWorld() { return world; }
+    const Compressor & GetCompressor() const { return compressor; }
+    const Checkpointer & GetCheckpointer() const { return checkpointer; }
+
+private:
+    Config config;
+    double time;
+
+    ServerAdapter adapter;
+    yojimbo::Server server;
+    int numChannels;
+
+    // Outgoing messages are queued per client and released within a per-tick
+    // byte budget estimated from the connection's RTT and packet loss. The
+    // game sends nothing yet: until snapshots and events are enqueued here,
+    // the scheduler only tracks the bandwidth estimates.
+    SendScheduler scheduler;
+
+    // Connected clients, indexed by client id. Per-tick work walks only
+    // these, idle timeouts come from the table's timer wheel. Slots are
+    // yojimbo's client indices.
+    ClientTable clients;
+    std::vector<uint64_t> packetsReceived;      // per slot, as of the last tick
+
+    // Bulk transfers (level data, inventories, chat history) are to go through
+    // the reliable channel as block messages, attached with
+    // AttachCompressedBlock(). The server sends none yet. The unreliable
+    // channel stays uncompressed for latency.
+    Compressor compressor;
+
+    // Match state, checkpointed so a restarted server resumes where it stopped.
+    // Captures are spread over ticks within the budget, written in the background.
+    EntityStore world;
+    Checkpointer checkpointer;
+
+    std::vector<double> tickSamples;            // ring buffer of tickWindow durations
+    uint64_t tickCount;
+    uint64_t tickOverruns;
+
+    SendScheduler::SendFunction sendMessage;
+    SendScheduler::DropFunction releaseMessage;
+};
@@ -23,13 +23,46 @@
 */
 
 #include "yojimbo.h"
+#include <inttypes.h>
 #include <signal.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #include "shared.h"
+#include "game_server.h"
+#include "memtrack.h"
+#include "net_relay.h"
+#include "server_admin.h"
 
 using namespace yojimbo;
 
+// yojimbo's allocations, netcode and reliable endpoints included, accounted
+// as network memory. Keeps DefaultAllocator's leak tracking.
+class TrackedAllocator : public Allocator
+{
+public:
+    void * Allocate( size_t size, const char * file, int line ) override
+    {
+        void * p = mem_alloc( size, MemTag::Network );
+        if ( !p )
+        {
+            SetErrorLevel( ALLOCATOR_ERROR_OUT_OF_MEMORY );
+            return NULL;
+        }
+        TrackAlloc( p, size, file, line );
+        return p;
+    }
+
+    void Free( void * p, const char * file, int line ) override
+    {
+        if ( !p )
+            return;
+        TrackFree( p, file, line );
+        mem_free( p );
+    }
+};
+
 static volatile int quit = 0;
 
 void interrupt_handler( int /*dummy*/ )
@@ -37,7 +70,7 @@ void interrupt_handler( int /*dummy*/ )
     quit = 1;
 }
 
-int ServerMain()
+int ServerMain( int argc, char * argv[] )
 {
     printf( "started server on port %d (insecure)\n", ServerPort );
 
@@ -48,40 +81,120 @@ int ServerMain()
     uint8_t privateKey[KeyBytes];
     memset( privateKey, 0, KeyBytes );
 
-    Server server( GetDefaultAllocator(), privateKey, Address( "127.0.0.1", ServerPort ), config, adapter, time );
+    TrackedAllocator allocator;
+
+    // Match state is checkpointed so a restarted server resumes where it
+    // stopped, see GameServer.
+    GameServer::Config gameConfig;
+    gameConfig.checkpoint.directory = "checkpoints";
+    gameConfig.checkpoint.interval = 5.0;
+    gameConfig.checkpoint.budget_ms = 0.5;
+
+    // Memory per subsystem, sampled every second, warnings past the budgets.
+    MemoryMonitor memory;
+    memory.SetBudget( MemTag::Network, 64 << 20 );
+    memory.SetBudget( MemTag::Game, 256 << 20 );
+    auto memoryWarning = []( MemTag tag, const MemTagStats & stats, int64_t budget )
+    {
+        printf( "warning: %s memory over budget, %.2f MiB of %.2f MiB\n", mem_tag_name( tag ), stats.live / 1048576.0, budget / 1048576.0 );
+    };
+
+    // The tick loop is game logic, anything not tagged by a library hook is
+    // accounted to the game.
+    MemScope gameScope( MemTag::Game );
+
+    // server [--net-... conditions] [--relay-port N] [--admin PATH]
+    //
+    // With --net-... options (see net_sim.h) the server also hosts a relay
+    // simulating them, for clients connecting with --via. The admin endpoint
+    // listens on a Unix domain socket, see server_admin.h for its commands.
+    NetSimConfig conditions;
+    int relayPort = ServerPort + 1;
+    const char * adminPath = "server.sock";
+    for ( int i = 1; i < argc; ++i )
+    {
+        if ( net_sim_parse_arg( conditions, argc, argv, i ) )
+            continue;
+        if ( !strcmp( argv[i], "--relay-port" ) && i + 1 < argc )
+            relayPort = atoi( argv[++i] );
+        else if ( !strcmp( argv[i], "--admin" ) && i + 1 < argc )
+            adminPath = argv[++i];
+    }
+
+    NetRelay relay( NetRelay::Config::Symmetric( conditions ) );
+    if ( conditions.IsActive() )
+    {
+        if ( !relay.Open( relayPort, "127.0.0.1", ServerPort ) )
+        {
+            printf( "error: cannot open the network simulator relay on port %d\n", relayPort );
+            return 1;
+        }
+        printf( "simulating %.0f ms latency, %.0f ms jitter, %.1f%% loss each way on port %d, connect with --via 127.0.0.1:%d\n",
+            conditions.latency_ms, conditions.jitter_ms, conditions.loss * 100.0, relayPort, relayPort );
+    }
+
+    GameServer gameServer( allocator, privateKey, Address( "127.0.0.1", ServerPort ), config, gameConfig, time );
 
-    server.Start( MaxClients );
+    gameServer.Start();
 
     char addressString[256];
-    server.GetAddress().ToString( addressString, sizeof( addressString ) );
+    gameServer.GetServer().GetAddress().ToString( addressString, sizeof( addressString ) );
     printf( "server address is %s\n", addressString );
 
-    const double deltaTime = 0.01f;
+    ServerSettings settings;
+
+    AdminSocket admin;
+    AddServerCommands( admin, gameServer, memory, settings );
+    if ( admin.Open( adminPath ) )
+        printf( "admin endpoint on %s\n", adminPath );
+    else
+        printf( "warning: cannot open the admin endpoint on %s\n", adminPath );
 
     signal( SIGINT, interrupt_handler );    
 
-    while ( !quit )
+    while ( !quit && !settings.stop )
     {
-        server.SendPackets();
+        admin.Poll();
+
+        // Changed from the admin endpoint, effective on this tick.
+        const double deltaTime = 1.0 / settings.tickRate;
 
-        server.ReceivePackets();
+        relay.Update( gameServer.GetTime() );
 
-        time += deltaTime;
+        gameServer.Tick( deltaTime );
 
-        server.AdvanceTime( time );
+        memory.Update( gameServer.GetTime(), memoryWarning );
 
-        if ( !server.IsRunning() )
+        if ( !gameServer.IsRunning() )
             break;
 
         yojimbo_sleep( deltaTime );
     }
 
-    server.Stop();
+    admin.Close();
+
+    gameServer.Stop();
+
+    const CheckpointStats checkpoints = gameServer.GetCheckpointer().GetStats();
+    printf( "checkpoints: %" PRIu64 " full, %" PRIu64 " deltas, %" PRIu64 " bytes; capture %.3f ms mean, %.3f ms worst tick, %" PRIu64 " of %" PRIu64 " ticks over budget\n",
+        checkpoints.full, checkpoints.deltas, checkpoints.bytes,
+        checkpoints.capture_ticks ? checkpoints.capture_ms_total / checkpoints.capture_ticks : 0.0,
+        checkpoints.capture_ms_max, checkpoints.over_budget, checkpoints.capture_ticks );
+
+    const CompressionStats & compression = gameServer.GetCompressor().GetStats();
+    if ( compression.messages )
+    {
+        printf( "bulk compression: %" PRIu64 " -> %" PRIu64 " bytes (ratio %.2f), %.3f ms compressing, %.3f ms decompressing\n",
+            compression.bytes_in, compression.bytes_out, compression.GetRatio(),
+            compression.compress_ns / 1000000.0, compression.decompress_ns / 1000000.0 );
+    }
+
+    memory.Report( []( const char * line ) { printf( "memory: %s\n", line ); } );
 
     return 0;
 }
 
-int main()
+int main( int argc, char * argv[] )
 {
     printf( "\n" );
 
@@ -95,7 +208,7 @@ int main()
 
     srand( (unsigned int) time( NULL ) );
 
-    int result = ServerMain();
+    int result = ServerMain( argc, argv );
 
     ShutdownYojimbo();
 
@@ -0,0 +1,135 @@
+#include "server_admin.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace yojimbo;
+
+static const char * const LogLevelNames[] = { "none", "error", "info", "debug" };
+
+template <typename... Args>
+static void AppendLine( std::string & out, const char * format, Args... args )
+{
+    char line[256];
+    snprintf( line, sizeof( line ), format, args... );
+    out += line;
+    out += '\n';
+}
+
+void AddServerCommands( AdminSocket & admin, GameServer & gameServer, const MemoryMonitor & memory, ServerSettings & settings )
+{
+    admin.Register( "status", "", "time, ticks, clients, entities, queued messages",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() != 1 )
+            return false;
+
+        size_t queued = 0;
+        for ( int i : gameServer.GetClients().GetActive() )
+            queued += gameServer.GetScheduler().GetQueueDepth( i );
+
+        AppendLine( out, "time %.2f, tick %" PRIu64 ", %.1f ticks per second", gameServer.GetTime(), gameServer.GetTickCount(), settings.tickRate );
+        AppendLine( out, "clients %d of %d, entities %d, queued messages %zu",
+            gameServer.GetClients().GetActiveCount(), gameServer.GetClients().GetCapacity(), gameServer.GetWorld().GetCount(), queued );
+
+        const CheckpointStats checkpoints = gameServer.GetCheckpointer().GetStats();
+        AppendLine( out, "checkpoints %" PRIu64 " full, %" PRIu64 " deltas, %" PRIu64 " write errors",
+            checkpoints.full, checkpoints.deltas, checkpoints.write_errors );
+        return true;
+    } );
+
+    admin.Register( "ticks", "", "tick duration percentiles over the last ticks",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() != 1 )
+            return false;
+
+        const Percentiles ticks = gameServer.GetTickPercentiles();
+        AppendLine( out, "ticks %d, p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms, %" PRIu64 " over",
+            gameServer.GetTickSampleCount(), ticks.p50, ticks.p90, ticks.p99, ticks.max, gameServer.GetTickOverruns() );
+        return true;
+    } );
+
+    admin.Register( "clients", "", "RTT, loss, bandwidth and send queue per client",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() != 1 )
+            return false;
+
+        AppendLine( out, "%-5s %-18s %8s %7s %9s %9s %9s %6s %8s %8s %7s",
+            "index", "id", "rtt ms", "loss %", "sent kbps", "recv kbps", "ackd kbps", "queue", "budget", "est kbps", "idle s" );
+        for ( int i : gameServer.GetClients().GetActive() )
+        {
+            NetworkInfo info;
+            gameServer.GetServer().GetNetworkInfo( i, info );
+            const SendScheduler & scheduler = gameServer.GetScheduler();
+            AppendLine( out, "%-5d %-18" PRIx64 " %8.1f %7.2f %9.1f %9.1f %9.1f %6zu %8d %8.1f %7.1f",
+                i, gameServer.GetClients().GetClientId( i ), info.RTT, info.packetLoss,
+                info.sentBandwidth, info.receivedBandwidth, info.ackedBandwidth,
+                scheduler.GetQueueDepth( i ), scheduler.GetTickBudget( i ), scheduler.GetEstimator( i ).GetEstimate(),
+                gameServer.GetTime() - gameServer.GetClients().GetLastSeen( i ) );
+        }
+        return true;
+    } );
+
+    admin.Register( "memory", "", "live and peak bytes per subsystem",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() != 1 )
+            return false;
+
+        memory.Report( [&]( const char * line ) { AppendLine( out, "%s", line ); } );
+        return true;
+    } );
+
+    admin.Register( "tickrate", "[HZ]", "shows or sets the tick rate, 1 to 1000",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() > 2 )
+            return false;
+
+        if ( args.size() == 2 )
+        {
+            const double rate = atof( args[1].c_str() );
+            if ( rate < 1.0 || rate > 1000.0 )
+                return false;
+            settings.tickRate = rate;
+        }
+
+        AppendLine( out, "tickrate %.1f", settings.tickRate );
+        return true;
+    } );
+
+    admin.Register( "loglevel", "[none|error|info|debug]", "shows or sets yojimbo's log level",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() > 2 )
+            return false;
+
+        if ( args.size() == 2 )
+        {
+            int level = 0;
+            while ( level < 4 && args[1] != LogLevelNames[level] )
+                ++level;
+            if ( level == 4 )
+                return false;
+            settings.logLevel = level;
+            yojimbo_log_level( level );
+        }
+
+        AppendLine( out, "loglevel %s", LogLevelNames[settings.logLevel] );
+        return true;
+    } );
+
+    admin.Register( "stop", "", "stops the server as SIGINT does",
+        [&]( const AdminSocket::Args & args, std::string & out )
+    {
+        if ( args.size() != 1 )
+            return false;
+
+        settings.stop = true;
+        out += "stopping\n";
+        return true;
+    } );
+}
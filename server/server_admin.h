@@ -0,0 +1,25 @@
+#pragma once
+
+#include "admin_socket.h"
+#include "game_server.h"
+#include "memtrack.h"
+
+// Settings the admin endpoint changes while the server runs, read by the
+// server loop every tick.
+struct ServerSettings
+{
+    double tickRate = 100.0;                    // ticks per second
+    int logLevel = YOJIMBO_LOG_LEVEL_INFO;
+    bool stop = false;
+};
+
+// The server's admin commands, see AdminSocket for the protocol:
+//
+//     status                   time, ticks, clients, entities, queued messages
+//     ticks                    tick duration percentiles
+//     clients                  RTT, loss, bandwidth and send queue per client
+//     memory                   live and peak bytes per subsystem
+//     tickrate [HZ]            shows or sets the tick rate
+//     loglevel [LEVEL]         shows or sets yojimbo's log level
+//     stop                     stops the server as SIGINT does
+void AddServerCommands( AdminSocket & admin, GameServer & gameServer, const MemoryMonitor & memory, ServerSettings & settings );
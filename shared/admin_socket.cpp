@@ -0,0 +1,201 @@
+#include "admin_socket.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0	// a closed peer raises SIGPIPE then
+#endif
+
+static bool make_address(const char *path, sockaddr_un &address)
+{
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address.sun_path)) return false;
+	strcpy(address.sun_path, path);
+	return true;
+}
+
+static bool set_nonblocking(int fd)
+{
+	return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) == 0;
+}
+
+static AdminSocket::Args split(const std::string &line)
+{
+	AdminSocket::Args args;
+	size_t			  start = 0;
+	while (start < line.size()) {
+		start = line.find_first_not_of(" \t\r", start);
+		if (start == std::string::npos) break;
+		size_t end = line.find_first_of(" \t\r", start);
+		if (end == std::string::npos) end = line.size();
+		args.push_back(line.substr(start, end - start));
+		start = end;
+	}
+	return args;
+}
+
+AdminSocket::AdminSocket(const Config &config) : config{config}, listen_socket{-1}
+{
+	Register("help", "", "this list", [this](const Args &, std::string &out) {
+		for (const auto &command : commands) {
+			out += command.name;
+			if (!command.usage.empty()) out += " " + command.usage;
+			out += "  -- " + command.help + "\n";
+		}
+		return true;
+	});
+}
+
+AdminSocket::~AdminSocket()
+{
+	Close();
+}
+
+bool AdminSocket::Open(const char *socket_path)
+{
+	Close();
+
+	sockaddr_un address;
+	if (!make_address(socket_path, address)) return false;
+
+	// Only a socket is ever removed: one nobody answers on was left by a
+	// crash, one that answers belongs to a running server. Anything else
+	// at the path is not ours to delete.
+	struct stat st;
+	if (lstat(socket_path, &st) == 0) {
+		if (!S_ISSOCK(st.st_mode)) return false;
+		int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (probe < 0) return false;
+		const bool live = connect(probe, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+		close(probe);
+		if (live || unlink(socket_path) < 0) return false;
+	} else if (errno != ENOENT) {
+		return false;
+	}
+
+	listen_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listen_socket < 0) return false;
+	if (bind(listen_socket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+		listen(listen_socket, config.max_connections) < 0 || !set_nonblocking(listen_socket)) {
+		close(listen_socket);
+		listen_socket = -1;
+		return false;
+	}
+	path = socket_path;
+	return true;
+}
+
+void AdminSocket::Close()
+{
+	for (auto &connection : connections) close(connection.socket);
+	connections.clear();
+	if (listen_socket >= 0) {
+		close(listen_socket);
+		unlink(path.c_str());
+	}
+	listen_socket = -1;
+	path.clear();
+}
+
+void AdminSocket::Register(const std::string &name, const std::string &usage, const std::string &help, Handler handler)
+{
+	commands.push_back({name, usage, help, std::move(handler)});
+}
+
+std::string AdminSocket::Execute(const std::string &line)
+{
+	const Args	args = split(line);
+	std::string out;
+	if (args.empty()) return "\n";
+
+	for (const auto &command : commands) {
+		if (command.name != args[0]) continue;
+		if (!command.handler(args, out)) out = "error: usage: " + command.name + " " + command.usage + "\n";
+		return out + "\n";
+	}
+	return "error: unknown command " + args[0] + ", try help\n\n";
+}
+
+int AdminSocket::Poll()
+{
+	if (listen_socket < 0) return 0;
+
+	for (;;) {
+		const int fd = accept(listen_socket, nullptr, nullptr);
+		if (fd < 0) break;
+		if (static_cast<int>(connections.size()) >= config.max_connections || !set_nonblocking(fd)) {
+			close(fd);
+			continue;
+		}
+		connections.push_back({fd, {}, {}});
+	}
+
+	// A client closing its end after the last request still gets the replies,
+	// as far as the socket buffer takes them.
+	int requests = 0;
+	for (size_t i = 0; i < connections.size();) {
+		auto	  &connection = connections[i];
+		const bool open		  = Read(connection);
+		requests += Run(connection);
+		if (Write(connection) && open && connection.input.size() <= config.max_request) {
+			i++;
+			continue;
+		}
+		close(connection.socket);
+		connections.erase(connections.begin() + i);
+	}
+	return requests;
+}
+
+// What arrived, false once the client closed its end or failed.
+bool AdminSocket::Read(Connection &connection)
+{
+	char buffer[1024];
+	while (connection.input.size() <= config.max_request) {
+		const auto bytes = recv(connection.socket, buffer, sizeof(buffer), 0);
+		if (bytes == 0) return false;
+		if (bytes < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		connection.input.append(buffer, bytes);
+
+		// Complete lines are run before reading on, a client streaming
+		// requests is bounded by its longest line.
+		if (connection.input.find('\n') != std::string::npos) break;
+	}
+	return true;
+}
+
+int AdminSocket::Run(Connection &connection)
+{
+	int	   requests = 0;
+	size_t start = 0, end;
+	while ((end = connection.input.find('\n', start)) != std::string::npos) {
+		connection.output += Execute(connection.input.substr(start, end - start));
+		requests++;
+		start = end + 1;
+	}
+	connection.input.erase(0, start);
+	return requests;
+}
+
+// False when the connection failed or let too much reply pile up.
+bool AdminSocket::Write(Connection &connection)
+{
+	while (!connection.output.empty()) {
+		const auto bytes = send(connection.socket, connection.output.data(), connection.output.size(), MSG_NOSIGNAL);
+		if (bytes < 0) {
+			if (errno == EINTR) continue;
+			if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+			break;
+		}
+		connection.output.erase(0, bytes);
+	}
+	return connection.output.size() <= config.max_pending;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Local control endpoint on a Unix domain socket, with a line based text
+// protocol for people and scripts alike:
+//
+//     $ socat - UNIX-CONNECT:server.sock
+//     ticks
+//     ticks 1000, p50 0.210 ms, p90 0.260 ms, p99 0.410 ms, max 1.020 ms, 0 over
+//
+// A request is a command and its arguments separated by spaces, on one line.
+// The reply is any number of lines followed by an empty one; a reply starting
+// with "error: " failed. `help` lists the commands.
+//
+// Nothing runs in the background: the owner calls Poll() from its loop and
+// the commands run there, free to touch its state without locking. Sockets
+// are non-blocking, a slow reader only costs memory for its pending reply.
+class AdminSocket
+{
+   public:
+	using Args = std::vector<std::string>;
+
+	// Appends the reply to `out`, a line per "\n". Returning false replies
+	// with the command's usage instead.
+	using Handler = std::function<bool(const Args &args, std::string &out)>;
+
+	struct Config
+	{
+		int	   max_connections	= 8;
+		size_t max_request		= 1024;		  // bytes per line, longer closes the connection
+		size_t max_pending		= 1 << 20;	  // unsent reply bytes, more closes the connection
+	};
+
+	AdminSocket() : AdminSocket(Config{}) {}
+	explicit AdminSocket(const Config &config);
+	~AdminSocket();
+
+	AdminSocket(const AdminSocket &)			= delete;
+	AdminSocket &operator=(const AdminSocket &) = delete;
+
+	// Listens at `path`, replacing a stale socket left by a previous run.
+	// Fails when a server answers there or the path is not a socket.
+	bool Open(const char *path);
+	void Close();
+	bool IsOpen() const { return listen_socket >= 0; }
+
+	// `usage` is the arguments, shown by help and on misuse.
+	void Register(const std::string &name, const std::string &usage, const std::string &help, Handler handler);
+
+	// Accepts connections, runs the complete requests, sends the replies.
+	// Returns the number of requests run.
+	int Poll();
+
+	// Runs a request line as if it came from a connection.
+	std::string Execute(const std::string &line);
+
+	int GetConnectionCount() const { return static_cast<int>(connections.size()); }
+
+   private:
+	struct Command
+	{
+		std::string name;
+		std::string usage;
+		std::string help;
+		Handler		handler;
+	};
+
+	struct Connection
+	{
+		int			socket;
+		std::string input;
+		std::string output;
+	};
+
+	Config					config;
+	int						listen_socket;
+	std::string				path;
+	std::vector<Command>	commands;
+	std::vector<Connection> connections;
+
+	bool Read(Connection &connection);
+	int	 Run(Connection &connection);
+	bool Write(Connection &connection);
+};
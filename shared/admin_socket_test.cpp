@@ -0,0 +1,161 @@
+#include "admin_socket.h"
+
+#include "check.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static int connect_to(const char *path)
+{
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	CHECK(fd >= 0);
+	return connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0 ? fd : (close(fd), -1);
+}
+
+static void send_text(int fd, const char *text)
+{
+	CHECK(write(fd, text, strlen(text)) == static_cast<ssize_t>(strlen(text)));
+}
+
+// Polls until `count` replies, each ended by an empty line, arrived.
+static std::string receive(AdminSocket &admin, int fd, int count)
+{
+	std::string reply;
+	for (int attempt = 0; attempt < 1000; attempt++) {
+		admin.Poll();
+		char buffer[4096];
+		auto bytes = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+		if (bytes > 0) reply.append(buffer, bytes);
+
+		int	   ends	 = 0;
+		size_t start = 0;
+		while ((start = reply.find("\n\n", start)) != std::string::npos) ends++, start += 2;
+		if (ends >= count) return reply;
+		usleep(1000);
+	}
+	return reply;
+}
+
+static void test_execute()
+{
+	AdminSocket admin;
+	int			rate = 100;
+	admin.Register("rate", "[HZ]", "tick rate", [&](const AdminSocket::Args &args, std::string &out) {
+		if (args.size() > 2) return false;
+		if (args.size() == 2) rate = atoi(args[1].c_str());
+		out += "rate " + std::to_string(rate) + "\n";
+		return true;
+	});
+
+	CHECK(admin.Execute("rate") == "rate 100\n\n");
+	CHECK(admin.Execute("  rate\t60 \r") == "rate 60\n\n");
+	CHECK(rate == 60);
+	CHECK(admin.Execute("rate 1 2") == "error: usage: rate [HZ]\n\n");
+	CHECK(admin.Execute("bogus").rfind("error: unknown command bogus", 0) == 0);
+	CHECK(admin.Execute("") == "\n");
+
+	const std::string help = admin.Execute("help");
+	CHECK(help.find("help  -- this list\n") != std::string::npos);
+	CHECK(help.find("rate [HZ]  -- tick rate\n") != std::string::npos);
+}
+
+static void test_socket()
+{
+	const std::string path = "/tmp/admin_socket_test." + std::to_string(getpid()) + ".sock";
+
+	AdminSocket::Config config;
+	config.max_connections = 2;
+	config.max_request	   = 64;
+	AdminSocket admin(config);
+	admin.Register("echo", "WORDS...", "repeats the words", [](const AdminSocket::Args &args, std::string &out) {
+		for (size_t i = 1; i < args.size(); i++) out += args[i] + "\n";
+		return true;
+	});
+	CHECK(admin.Open(path.c_str()));
+
+	// A running server's socket is not taken over.
+	AdminSocket other;
+	CHECK(!other.Open(path.c_str()));
+
+	int first = connect_to(path.c_str());
+	CHECK(first >= 0);
+
+	// Requests split across writes, and several in one.
+	send_text(first, "echo a");
+	CHECK(receive(admin, first, 1).empty());
+	send_text(first, " b\necho c\n");
+	CHECK(receive(admin, first, 2) == "a\nb\n\nc\n\n");
+	CHECK(admin.GetConnectionCount() == 1);
+
+	// Past max_connections, new connections are closed.
+	int second = connect_to(path.c_str());
+	int third  = connect_to(path.c_str());
+	admin.Poll();
+	CHECK(admin.GetConnectionCount() == 2);
+	char byte;
+	usleep(1000);
+	CHECK(recv(third, &byte, 1, MSG_DONTWAIT) == 0);
+	close(third);
+
+	// An overlong line closes the connection.
+	send_text(second, std::string(100, 'x').c_str());
+	admin.Poll();
+	CHECK(admin.GetConnectionCount() == 1);
+	close(second);
+
+	// Replies still go out to a client that closed its end after asking.
+	send_text(first, "echo last\n");
+	shutdown(first, SHUT_WR);
+	CHECK(receive(admin, first, 1) == "last\n\n");
+	admin.Poll();
+	CHECK(admin.GetConnectionCount() == 0);
+	close(first);
+
+	admin.Close();
+	CHECK(connect_to(path.c_str()) < 0);
+
+	// A stale socket file, left by a crash, is replaced.
+	sockaddr_un address{};
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path.c_str());
+	int crashed = socket(AF_UNIX, SOCK_STREAM, 0);
+	CHECK(bind(crashed, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+	close(crashed);
+	CHECK(access(path.c_str(), F_OK) == 0);
+
+	AdminSocket stale;
+	CHECK(stale.Open(path.c_str()));
+	int fd = connect_to(path.c_str());
+	CHECK(fd >= 0);
+	send_text(fd, "help\n");
+	CHECK(receive(stale, fd, 1).rfind("help", 0) == 0);
+	close(fd);
+	stale.Close();
+	CHECK(access(path.c_str(), F_OK) != 0);
+
+	// A file that is not a socket is left alone.
+	FILE *file = fopen(path.c_str(), "w");
+	CHECK(file);
+	fclose(file);
+	AdminSocket misplaced;
+	CHECK(!misplaced.Open(path.c_str()));
+	CHECK(access(path.c_str(), F_OK) == 0);
+	unlink(path.c_str());
+}
+
+int main()
+{
+	test_execute();
+	test_socket();
+	printf("admin_socket_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stats.h"
+
+// Minimal benchmark harness: timed cases reported as percentiles, plus
+// plain counters (geometry calls per frame, bytes, ...).
+class Bench
+{
+   public:
+	using Clock = std::chrono::steady_clock;
+
+	struct Result
+	{
+		std::string name;
+		int			iterations;
+		double		mean_ms;
+		Percentiles ms;
+	};
+
+	explicit Bench(std::string suite) : suite{std::move(suite)} {}
+
+	// Times `iterations` calls of `body` individually.
+	template <typename Body>
+	void Run(const std::string &name, int iterations, Body &&body)
+	{
+		std::vector<double> samples_ms;
+		samples_ms.reserve(iterations);
+		for (int i = 0; i < iterations; i++) {
+			auto start = Clock::now();
+			body();
+			samples_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+		}
+		Record(name, samples_ms);
+	}
+
+	// Adds externally timed samples, in milliseconds.
+	void Record(const std::string &name, std::vector<double> samples_ms)
+	{
+		Result result;
+		result.name		  = name;
+		result.iterations = static_cast<int>(samples_ms.size());
+		result.mean_ms	  = 0.0;
+		for (double sample : samples_ms) result.mean_ms += sample / samples_ms.size();
+		result.ms = compute_percentiles(samples_ms);
+		results.push_back(result);
+	}
+
+	void Counter(const std::string &name, double value) { counters.emplace_back(name, value); }
+
+	void Print(FILE *out = stdout) const
+	{
+		fprintf(out, "%s\n", suite.c_str());
+		fprintf(out, "  %-32s %8s %10s %10s %10s %10s %10s\n", "case", "iters", "mean ms", "p50 ms", "p90 ms", "p99 ms", "max ms");
+		for (const auto &result : results)
+			fprintf(out, "  %-32s %8d %10.4f %10.4f %10.4f %10.4f %10.4f\n", result.name.c_str(), result.iterations,
+					result.mean_ms, result.ms.p50, result.ms.p90, result.ms.p99, result.ms.max);
+		for (const auto &counter : counters)
+			fprintf(out, "  %-32s %12.2f\n", counter.first.c_str(), counter.second);
+	}
+
+	const std::string								   &GetSuite() const { return suite; }
+	const std::vector<Result>						   &GetResults() const { return results; }
+	const std::vector<std::pair<std::string, double>> &GetCounters() const { return counters; }
+
+   private:
+	std::string								 suite;
+	std::vector<Result>						 results;
+	std::vector<std::pair<std::string, double>> counters;
+};
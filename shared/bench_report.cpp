@@ -0,0 +1,286 @@
+#include "bench_report.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+void BenchReport::Add(const Bench &bench)
+{
+	for (auto result : bench.GetResults()) {
+		result.name = bench.GetSuite() + "/" + result.name;
+		cases.push_back(result);
+	}
+	for (const auto &counter : bench.GetCounters()) counters.push_back({bench.GetSuite() + "/" + counter.first, counter.second});
+}
+
+// --- Writing -------------------------------------------------------------
+
+static void append_string(std::string &out, const std::string &value)
+{
+	out += '"';
+	for (char c : value) {
+		if (c == '"' || c == '\\') {
+			out += '\\';
+			out += c;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			char escape[8];
+			snprintf(escape, sizeof(escape), "\\u%04x", c);
+			out += escape;
+		} else
+			out += c;
+	}
+	out += '"';
+}
+
+static void append_number(std::string &out, const char *key, double value)
+{
+	char number[48];
+	snprintf(number, sizeof(number), ", \"%s\": %.9g", key, value);
+	out += number;
+}
+
+std::string BenchReport::ToJSON() const
+{
+	std::string out = "{\n  \"cases\": [";
+	for (size_t i = 0; i < cases.size(); i++) {
+		const auto &result = cases[i];
+		out += i ? ",\n    {\"name\": " : "\n    {\"name\": ";
+		append_string(out, result.name);
+		append_number(out, "iterations", result.iterations);
+		append_number(out, "mean_ms", result.mean_ms);
+		append_number(out, "p50_ms", result.ms.p50);
+		append_number(out, "p90_ms", result.ms.p90);
+		append_number(out, "p99_ms", result.ms.p99);
+		append_number(out, "max_ms", result.ms.max);
+		out += '}';
+	}
+	out += cases.empty() ? "],\n  \"counters\": [" : "\n  ],\n  \"counters\": [";
+	for (size_t i = 0; i < counters.size(); i++) {
+		out += i ? ",\n    {\"name\": " : "\n    {\"name\": ";
+		append_string(out, counters[i].name);
+		append_number(out, "value", counters[i].value);
+		out += '}';
+	}
+	out += counters.empty() ? "]\n}\n" : "\n  ]\n}\n";
+	return out;
+}
+
+bool BenchReport::Write(const std::string &path) const
+{
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) return false;
+
+	const std::string json = ToJSON();
+	bool			  ok   = fwrite(json.data(), 1, json.size(), file) == json.size();
+	return fclose(file) == 0 && ok;
+}
+
+// --- Reading -------------------------------------------------------------
+
+// Just enough JSON for reports: objects, arrays, strings, numbers and the
+// literals, no \u escapes beyond ASCII.
+class JsonReader
+{
+	const char *at;
+	const char *end;
+
+   public:
+	JsonReader(const std::string &json) : at{json.data()}, end{json.data() + json.size()} {}
+
+	void SkipSpace()
+	{
+		while (at < end && (*at == ' ' || *at == '\t' || *at == '\n' || *at == '\r')) at++;
+	}
+
+	bool Peek(char c)
+	{
+		SkipSpace();
+		return at < end && *at == c;
+	}
+
+	bool Expect(char c)
+	{
+		if (!Peek(c)) return false;
+		at++;
+		return true;
+	}
+
+	bool AtEnd()
+	{
+		SkipSpace();
+		return at == end;
+	}
+
+	bool String(std::string &out)
+	{
+		if (!Expect('"')) return false;
+		out.clear();
+		while (at < end && *at != '"') {
+			char c = *at++;
+			if (c == '\\') {
+				if (at == end) return false;
+				c = *at++;
+				switch (c) {
+					case 'n': c = '\n'; break;
+					case 't': c = '\t'; break;
+					case 'r': c = '\r'; break;
+					case 'b': c = '\b'; break;
+					case 'f': c = '\f'; break;
+					case 'u': {
+						if (end - at < 4) return false;
+						const std::string hex(at, 4);
+						char			 *hex_end;
+						const long		  code = strtol(hex.c_str(), &hex_end, 16);
+						if (hex_end != hex.c_str() + 4 || code > 0x7f) return false;
+						c = static_cast<char>(code);
+						at += 4;
+						break;
+					}
+					default: break;	 // \" \\ \/
+				}
+			}
+			out += c;
+		}
+		return Expect('"');
+	}
+
+	bool Number(double &out)
+	{
+		SkipSpace();
+		const std::string text(at, std::min<size_t>(end - at, 64));
+		char			 *number_end;
+		out = strtod(text.c_str(), &number_end);
+		if (number_end == text.c_str()) return false;
+		at += number_end - text.c_str();
+		return true;
+	}
+
+	bool Literal(const char *word)
+	{
+		SkipSpace();
+		for (const char *c = word; *c; c++, at++)
+			if (at == end || *at != *c) return false;
+		return true;
+	}
+
+	// Calls member(key) for every member of an object, member() parses the
+	// value.
+	template <typename Member>
+	bool Object(Member &&member)
+	{
+		if (!Expect('{')) return false;
+		if (Expect('}')) return true;
+		std::string key;
+		do {
+			if (!String(key) || !Expect(':') || !member(key)) return false;
+		} while (Expect(','));
+		return Expect('}');
+	}
+
+	template <typename Element>
+	bool Array(Element &&element)
+	{
+		if (!Expect('[')) return false;
+		if (Expect(']')) return true;
+		do {
+			if (!element()) return false;
+		} while (Expect(','));
+		return Expect(']');
+	}
+
+	bool Skip()
+	{
+		std::string text;
+		double		number;
+		if (Peek('{')) return Object([&](const std::string &) { return Skip(); });
+		if (Peek('[')) return Array([&] { return Skip(); });
+		if (Peek('"')) return String(text);
+		if (Peek('t')) return Literal("true");
+		if (Peek('f')) return Literal("false");
+		if (Peek('n')) return Literal("null");
+		return Number(number);
+	}
+};
+
+bool BenchReport::Parse(const std::string &json)
+{
+	cases.clear();
+	counters.clear();
+
+	JsonReader reader(json);
+
+	auto parse_case = [&] {
+		Bench::Result result{};
+		double		  iterations = 0;
+		const bool	  ok		 = reader.Object([&](const std::string &key) {
+			if (key == "name") return reader.String(result.name);
+			if (key == "iterations") return reader.Number(iterations);
+			if (key == "mean_ms") return reader.Number(result.mean_ms);
+			if (key == "p50_ms") return reader.Number(result.ms.p50);
+			if (key == "p90_ms") return reader.Number(result.ms.p90);
+			if (key == "p99_ms") return reader.Number(result.ms.p99);
+			if (key == "max_ms") return reader.Number(result.ms.max);
+			return reader.Skip();
+		});
+		result.iterations = static_cast<int>(iterations);
+		cases.push_back(result);
+		return ok && !result.name.empty();
+	};
+
+	auto parse_counter = [&] {
+		Counter	   counter{};
+		const bool ok = reader.Object([&](const std::string &key) {
+			if (key == "name") return reader.String(counter.name);
+			if (key == "value") return reader.Number(counter.value);
+			return reader.Skip();
+		});
+		counters.push_back(counter);
+		return ok && !counter.name.empty();
+	};
+
+	const bool ok = reader.Object([&](const std::string &key) {
+		if (key == "cases") return reader.Array(parse_case);
+		if (key == "counters") return reader.Array(parse_counter);
+		return reader.Skip();
+	});
+	if (ok && reader.AtEnd()) return true;
+
+	cases.clear();
+	counters.clear();
+	return false;
+}
+
+bool BenchReport::Load(const std::string &path)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) return false;
+
+	std::string json;
+	char		buffer[4096];
+	while (size_t read = fread(buffer, 1, sizeof(buffer), file)) json.append(buffer, read);
+	fclose(file);
+	return Parse(json);
+}
+
+// --- Comparison ----------------------------------------------------------
+
+const Bench::Result *BenchReport::Find(const std::string &name) const
+{
+	for (const auto &result : cases)
+		if (result.name == name) return &result;
+	return nullptr;
+}
+
+std::vector<BenchReport::Regression> BenchReport::Compare(const BenchReport &baseline, double tolerance, double min_delta_ms) const
+{
+	std::vector<Regression> regressions;
+	for (const auto &result : cases) {
+		const Bench::Result *before = baseline.Find(result.name);
+		if (!before) continue;
+
+		const double delta = result.ms.p50 - before->ms.p50;
+		if (delta > before->ms.p50 * tolerance && delta >= min_delta_ms)
+			regressions.push_back({result.name, before->ms.p50, result.ms.p50});
+	}
+	return regressions;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+// Benchmark results as JSON, kept by CI and compared against a baseline.
+//
+//     {
+//       "cases": [
+//         {"name": "suite/case", "iterations": 200, "mean_ms": 0.12, "p50_ms": 0.11, "p90_ms": 0.13, "p99_ms": 0.2, "max_ms": 0.4}
+//       ],
+//       "counters": [
+//         {"name": "suite/counter", "value": 1024}
+//       ]
+//     }
+//
+// Compare() goes by the median, the statistic a noisy CI machine moves the
+// least. Cases present on only one side are not compared, so adding or
+// renaming a case does not fail the run.
+class BenchReport
+{
+   public:
+	struct Counter
+	{
+		std::string name;
+		double		value;
+	};
+
+	struct Regression
+	{
+		std::string name;
+		double		baseline_ms;  // p50
+		double		current_ms;
+	};
+
+	// Adds the suite's results, named "suite/case".
+	void Add(const Bench &bench);
+
+	std::string ToJSON() const;
+	bool		Write(const std::string &path) const;
+
+	// Reads JSON in the format ToJSON() writes, unknown fields are skipped.
+	// False on malformed input, leaving the report empty.
+	bool Parse(const std::string &json);
+	bool Load(const std::string &path);
+
+	// Cases whose median is over the baseline's by more than `tolerance`
+	// (0.2 for 20 %) and by at least `min_delta_ms`, which keeps
+	// microsecond-scale cases from failing on timer noise.
+	std::vector<Regression> Compare(const BenchReport &baseline, double tolerance, double min_delta_ms) const;
+
+	const Bench::Result *Find(const std::string &name) const;
+
+	const std::vector<Bench::Result> &GetCases() const { return cases; }
+	const std::vector<Counter>		 &GetCounters() const { return counters; }
+
+   private:
+	std::vector<Bench::Result> cases;
+	std::vector<Counter>	   counters;
+};
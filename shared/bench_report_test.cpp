@@ -0,0 +1,104 @@
+#include "bench_report.h"
+
+#include "check.h"
+
+#include <cstdio>
+
+static Bench make_bench(const char *suite, double p50)
+{
+	Bench bench(suite);
+	bench.Record("steady", {p50, p50, p50});
+	bench.Record("tiny", {p50 / 1000, p50 / 1000, p50 / 1000});
+	bench.Counter("vertices", 1024);
+	return bench;
+}
+
+static void test_round_trip()
+{
+	BenchReport report;
+	report.Add(make_bench("render", 2.0));
+	report.Add(make_bench("keys \"quoted\"", 1.0));
+
+	BenchReport loaded;
+	CHECK(loaded.Parse(report.ToJSON()));
+	CHECK(loaded.GetCases().size() == 4);
+	CHECK(loaded.GetCounters().size() == 2);
+
+	const Bench::Result *steady = loaded.Find("render/steady");
+	CHECK(steady);
+	CHECK(steady->iterations == 3);
+	CHECK(steady->mean_ms == 2.0 && steady->ms.p50 == 2.0 && steady->ms.max == 2.0);
+	CHECK(loaded.Find("keys \"quoted\"/tiny"));
+	CHECK(loaded.GetCounters()[0].name == "render/vertices" && loaded.GetCounters()[0].value == 1024);
+
+	BenchReport empty;
+	CHECK(loaded.Parse(empty.ToJSON()));
+	CHECK(loaded.GetCases().empty());
+}
+
+static void test_parse()
+{
+	BenchReport report;
+
+	// Unknown fields, at any level, are skipped.
+	CHECK(report.Parse(R"({"machine": {"cpu": "x", "cores": [1, 2]}, "ok": true,
+		"cases": [{"name": "a\/b", "p50_ms": 1e-3, "extra": null}], "counters": []})"));
+	CHECK(report.GetCases().size() == 1);
+	CHECK(report.Find("a/b")->ms.p50 == 0.001);
+
+	CHECK(!report.Parse(""));
+	CHECK(!report.Parse("{\"cases\": [{\"name\": \"a\", \"p50_ms\": }]}"));
+	CHECK(!report.Parse("{\"cases\": [{\"p50_ms\": 1}]}"));	 // unnamed
+	CHECK(!report.Parse("{\"cases\": []} trailing"));
+	CHECK(report.GetCases().empty());
+}
+
+static void test_compare()
+{
+	BenchReport baseline, same, slower, faster;
+	baseline.Add(make_bench("render", 2.0));
+	same.Add(make_bench("render", 2.2));
+	slower.Add(make_bench("render", 3.0));
+	faster.Add(make_bench("render", 1.0));
+
+	CHECK(same.Compare(baseline, 0.2, 0.0).empty());
+	CHECK(faster.Compare(baseline, 0.2, 0.0).empty());
+
+	// Both cases are 50 % slower, the tiny one by less than the noise floor.
+	auto regressions = slower.Compare(baseline, 0.2, 0.01);
+	CHECK(regressions.size() == 1);
+	CHECK(regressions[0].name == "render/steady");
+	CHECK(regressions[0].baseline_ms == 2.0 && regressions[0].current_ms == 3.0);
+	CHECK(slower.Compare(baseline, 0.2, 0.0).size() == 2);
+
+	// Cases only on one side are not compared.
+	BenchReport other;
+	other.Add(make_bench("files", 100.0));
+	CHECK(other.Compare(baseline, 0.2, 0.0).empty());
+}
+
+static void test_files()
+{
+	const char *path = "bench_report_test.json";
+
+	BenchReport report;
+	report.Add(make_bench("render", 2.0));
+	CHECK(report.Write(path));
+
+	BenchReport loaded;
+	CHECK(loaded.Load(path));
+	CHECK(loaded.ToJSON() == report.ToJSON());
+	remove(path);
+
+	CHECK(!loaded.Load(path));
+}
+
+int main()
+{
+	test_round_trip();
+	test_parse();
+	test_compare();
+	test_files();
+	printf("bench_report_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Transparent compression of yojimbo block messages.
+//
+// Blocks attached through these helpers carry the Compressor codec byte, the
+// receiver decodes them with ReadCompressedBlock() whether or not the sender
+// actually compressed. Only include where yojimbo is available.
+
+#include "compress.h"
+#include "yojimbo.h"
+
+inline bool AttachCompressedBlock(yojimbo::Server &server, int clientIndex, int channelIndex, yojimbo::BlockMessage *message,
+								  const uint8_t *data, int bytes, Compressor &compressor, std::vector<uint8_t> &scratch)
+{
+	if (!compressor.Encode(channelIndex, data, bytes, scratch)) return false;
+
+	uint8_t *block = server.AllocateBlock(clientIndex, static_cast<int>(scratch.size()));
+	if (!block) return false;
+
+	memcpy(block, scratch.data(), scratch.size());
+	server.AttachBlockToMessage(clientIndex, message, block, static_cast<int>(scratch.size()));
+	return true;
+}
+
+inline bool AttachCompressedBlock(yojimbo::Client &client, int channelIndex, yojimbo::BlockMessage *message,
+								  const uint8_t *data, int bytes, Compressor &compressor, std::vector<uint8_t> &scratch)
+{
+	if (!compressor.Encode(channelIndex, data, bytes, scratch)) return false;
+
+	uint8_t *block = client.AllocateBlock(static_cast<int>(scratch.size()));
+	if (!block) return false;
+
+	memcpy(block, scratch.data(), scratch.size());
+	client.AttachBlockToMessage(message, block, static_cast<int>(scratch.size()));
+	return true;
+}
+
+inline bool ReadCompressedBlock(yojimbo::BlockMessage *message, Compressor &compressor, std::vector<uint8_t> &out)
+{
+	if (!message->GetBlockData()) return false;
+	return compressor.Decode(message->GetBlockData(), message->GetBlockSize(), out);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Test assertion that, unlike assert(), is never compiled out: tests built
+// with NDEBUG (ReleaseFast, ReleaseSmall) still evaluate every expression,
+// calls under test included, and abort on the first failure.
+#define CHECK(expression) \
+	((expression) ? static_cast<void>(0) \
+				  : (fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #expression), abort()))
@@ -0,0 +1,530 @@
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+
+#include "compress.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsed_ms(Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// --- File format ---------------------------------------------------------
+//
+//     u32 magic, u16 version, u8 kind (0 full, 1 delta), u8 reserved
+//     u32 generation, u32 index
+//     u64 since_tick, u64 start_tick, u64 end_tick
+//     u32 next_id, u32 entity count, u32 removed count
+//     u32 payload size, u32 payload FNV-1a
+//
+// The payload is a Compressor encoding of the records: entities sorted by id
+// as varint id gap, type and flags, then zigzag varints of the raw position
+// and velocity; despawned ids sorted, as varint gaps.
+
+static const size_t HeaderSize = 60;
+
+// Decoded records per file, far beyond any world the server keeps in memory.
+static const size_t MaxRecordBytes = 1u << 30;
+
+enum CheckpointKind : uint8_t {
+	KIND_FULL  = 0,
+	KIND_DELTA = 1,
+};
+
+static void put_u16(uint8_t *out, uint16_t value)
+{
+	out[0] = value & 0xff;
+	out[1] = value >> 8;
+}
+
+static void put_u32(uint8_t *out, uint32_t value)
+{
+	for (int i = 0; i < 4; i++) out[i] = (value >> (i * 8)) & 0xff;
+}
+
+static void put_u64(uint8_t *out, uint64_t value)
+{
+	for (int i = 0; i < 8; i++) out[i] = (value >> (i * 8)) & 0xff;
+}
+
+static uint16_t get_u16(const uint8_t *in)
+{
+	return static_cast<uint16_t>(in[0] | in[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *in)
+{
+	uint32_t value = 0;
+	for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(in[i]) << (i * 8);
+	return value;
+}
+
+static uint64_t get_u64(const uint8_t *in)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(in[i]) << (i * 8);
+	return value;
+}
+
+static void put_varint(std::vector<uint8_t> &out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+static bool get_varint(const uint8_t *&in, const uint8_t *end, uint64_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (in == end) return false;
+		const uint8_t byte = *in++;
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) return true;
+	}
+	return false;
+}
+
+static uint32_t zigzag(int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+	return static_cast<int32_t>((value >> 1) ^ (0u - (value & 1)));
+}
+
+static uint32_t fnv1a(const uint8_t *data, size_t size)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 16777619u;
+	return hash;
+}
+
+static std::string checkpoint_path(const std::string &directory, uint32_t index)
+{
+	if (!index) return directory + "/full.ckpt";
+
+	char name[32];
+	snprintf(name, sizeof(name), "/delta-%04u.ckpt", index);
+	return directory + name;
+}
+
+struct CheckpointFile
+{
+	bool				  full;
+	uint32_t			  generation;
+	uint32_t			  index;
+	uint64_t			  end_tick;
+	uint32_t			  next_id;
+	std::vector<Entity>	  entities;
+	std::vector<uint32_t> removed;
+	std::vector<uint8_t>  payload;
+	std::vector<uint8_t>  records;
+};
+
+// Reads and validates one checkpoint, false for missing or damaged files.
+static bool read_checkpoint(const std::string &path, Compressor &compressor, CheckpointFile &checkpoint)
+{
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) return false;
+
+	uint8_t header[HeaderSize];
+	bool	ok = fread(header, 1, HeaderSize, file) == HeaderSize && get_u32(header) == Checkpointer::Magic
+			&& get_u16(header + 4) == Checkpointer::Version && header[6] <= KIND_DELTA;
+	// The payload size is checked against the file before allocating for it.
+	long file_size = -1;
+	if (ok && fseek(file, 0, SEEK_END) == 0) file_size = ftell(file);
+	ok = ok && file_size >= 0 && get_u32(header + 52) <= static_cast<unsigned long>(file_size) - HeaderSize
+	  && fseek(file, HeaderSize, SEEK_SET) == 0;
+	if (ok) {
+		checkpoint.payload.resize(get_u32(header + 52));
+		ok = fread(checkpoint.payload.data(), 1, checkpoint.payload.size(), file) == checkpoint.payload.size()
+		  && fnv1a(checkpoint.payload.data(), checkpoint.payload.size()) == get_u32(header + 56);
+	}
+	fclose(file);
+	if (!ok || !compressor.Decode(checkpoint.payload.data(), checkpoint.payload.size(), checkpoint.records)) return false;
+
+	checkpoint.full			 = header[6] == KIND_FULL;
+	checkpoint.generation	 = get_u32(header + 8);
+	checkpoint.index		 = get_u32(header + 12);
+	checkpoint.end_tick		 = get_u64(header + 32);
+	checkpoint.next_id		 = get_u32(header + 40);
+	const auto entity_count	 = get_u32(header + 44);
+	const auto removed_count = get_u32(header + 48);
+
+	const uint8_t *in  = checkpoint.records.data();
+	const uint8_t *end = in + checkpoint.records.size();
+	if (entity_count > checkpoint.records.size() || removed_count > checkpoint.records.size()) return false;
+
+	uint64_t id = 0;
+	checkpoint.entities.resize(entity_count);
+	for (auto &entity : checkpoint.entities) {
+		uint64_t gap, type, flags, values[4];
+		if (!get_varint(in, end, gap) || !get_varint(in, end, type) || !get_varint(in, end, flags)) return false;
+		for (auto &value : values)
+			if (!get_varint(in, end, value)) return false;
+
+		id += gap;
+		entity.id		  = static_cast<uint32_t>(id);
+		entity.type		  = static_cast<uint16_t>(type);
+		entity.flags	  = static_cast<uint16_t>(flags);
+		entity.position.x = Fixed::FromRaw(unzigzag(static_cast<uint32_t>(values[0])));
+		entity.position.y = Fixed::FromRaw(unzigzag(static_cast<uint32_t>(values[1])));
+		entity.velocity.x = Fixed::FromRaw(unzigzag(static_cast<uint32_t>(values[2])));
+		entity.velocity.y = Fixed::FromRaw(unzigzag(static_cast<uint32_t>(values[3])));
+	}
+
+	id = 0;
+	checkpoint.removed.resize(removed_count);
+	for (auto &removed_id : checkpoint.removed) {
+		uint64_t gap;
+		if (!get_varint(in, end, gap)) return false;
+		id += gap;
+		removed_id = static_cast<uint32_t>(id);
+	}
+	return in == end;
+}
+
+// --- Checkpointer --------------------------------------------------------
+
+Checkpointer::Checkpointer(const Config &config)
+	: config{config},
+	  filling{0},
+	  capturing{false},
+	  captured{false},
+	  cursor{0},
+	  next_due{0.0},
+	  generation{0},
+	  delta_index{0},
+	  last_start_tick{0},
+	  ns_per_entity{50.0, 50.0},  // conservative until measured
+	  writing{nullptr},
+	  stopping{false},
+	  last_ok{true},
+	  stats{}
+{
+	std::error_code error;
+	std::filesystem::create_directories(config.directory, error);
+
+	writer = std::thread([this] { Write(); });
+}
+
+Checkpointer::~Checkpointer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+}
+
+CheckpointStats Checkpointer::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return stats;
+}
+
+bool Checkpointer::Restore(EntityStore &store, RestoreInfo *info)
+{
+	Compressor::Config decode;
+	decode.max_decoded_size = MaxRecordBytes;
+
+	auto		   start = Clock::now();
+	Compressor	   compressor(decode, nullptr, 0);
+	CheckpointFile checkpoint;
+	RestoreInfo	   restored{};
+
+	if (!read_checkpoint(checkpoint_path(config.directory, 0), compressor, checkpoint) || !checkpoint.full) return false;
+
+	// Entities before despawns: a despawned id is never reused, and a sliced
+	// capture may hold an entity despawned after it was copied.
+	auto apply = [&] {
+		store.SetTick(checkpoint.end_tick);
+		for (const auto &entity : checkpoint.entities) store.Put(entity);
+		for (uint32_t id : checkpoint.removed) store.Erase(id);
+		store.SetNextId(std::max(store.GetNextId(), checkpoint.next_id));
+	};
+
+	store.Clear();
+	apply();
+	restored.generation = checkpoint.generation;
+
+	for (uint32_t index = 1;; index++) {
+		if (!read_checkpoint(checkpoint_path(config.directory, index), compressor, checkpoint) || checkpoint.full
+			|| checkpoint.generation != restored.generation || checkpoint.index != index)
+			break;
+		apply();
+		restored.deltas++;
+	}
+
+	// Deltas continue a chain from its captures, a new one starts with a full
+	// checkpoint in the next generation.
+	generation		= restored.generation;
+	delta_index		= config.full_every;
+	last_start_tick = store.GetTick();
+
+	restored.tick = store.GetTick();
+	restored.ms	  = elapsed_ms(start);
+	if (info) *info = restored;
+	return true;
+}
+
+void Checkpointer::Begin(EntityStore &store, bool full)
+{
+	Capture &capture = buffers[filling];
+	if (full) {
+		generation++;
+		delta_index = 0;
+	}
+	else
+		delta_index++;
+
+	capture.full	   = full;
+	capture.generation = generation;
+	capture.index	   = delta_index;
+	capture.since_tick = full ? 0 : last_start_tick;
+	capture.start_tick = store.GetTick();
+	capture.entities.clear();
+	capture.removed.clear();
+	if (full) capture.entities.reserve(store.GetEntities().size());
+
+	last_start_tick = capture.start_tick;
+	cursor			= store.GetEntities().size();
+	capturing		= true;
+}
+
+void Checkpointer::Scan(const EntityStore &store, size_t count)
+{
+	Capture	   &capture = buffers[filling];
+	const auto &entities = store.GetEntities();
+	const auto &changed	 = store.GetChangeTicks();
+
+	cursor = std::min(cursor, entities.size());
+	for (; count && cursor; count--) {
+		cursor--;
+		if (capture.full || changed[cursor] >= capture.since_tick) capture.entities.push_back(entities[cursor]);
+	}
+}
+
+void Checkpointer::Finish(EntityStore &store)
+{
+	Capture &capture = buffers[filling];
+	capture.end_tick = store.GetTick();
+	capture.next_id	 = store.GetNextId();
+
+	// Despawns since the capture started, for a full one, or since the
+	// previous one started, for a delta.
+	const uint64_t removed_since = capture.full ? capture.start_tick : capture.since_tick;
+	for (const auto &removal : store.GetRemovals())
+		if (removal.tick >= removed_since) capture.removed.push_back(removal.id);
+	store.TrimRemovals(capture.start_tick);
+
+	capturing = false;
+	captured  = true;
+	HandOff();
+}
+
+bool Checkpointer::HandOff()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (writing) return false;
+		writing = &buffers[filling];
+	}
+	filling ^= 1;
+	captured = false;
+	wake.notify_one();
+	return true;
+}
+
+void Checkpointer::Update(EntityStore &store, double time)
+{
+	if (captured) {
+		if (!HandOff()) {
+			std::lock_guard<std::mutex> lock(mutex);
+			stats.deferred++;
+		}
+		return;
+	}
+	if (!capturing && time < next_due) return;
+
+	auto start = Clock::now();
+	if (!capturing) {
+		// A failed write breaks the chain of deltas, start a new one.
+		bool chained;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			chained = last_ok;
+		}
+		next_due = time + config.interval;
+		Begin(store, !chained || generation == 0 || static_cast<int>(delta_index) + 1 >= config.full_every);
+	}
+
+	// Slices sized from the measured per-entity cost to fill the budget.
+	const size_t before = cursor;
+	double		&cost	= ns_per_entity[buffers[filling].full];
+	const size_t slice	= std::max<size_t>(256, static_cast<size_t>(config.budget_ms * 1000000.0 / cost));
+	Scan(store, slice);
+	const size_t scanned = before - cursor;
+	if (!cursor) Finish(store);
+
+	const double ms = elapsed_ms(start);
+	if (scanned >= 256) cost = cost * 0.75 + ms * 1000000.0 / scanned * 0.25;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	stats.capture_ticks++;
+	stats.capture_ms_total += ms;
+	stats.capture_ms_max = std::max(stats.capture_ms_max, ms);
+	if (ms > config.budget_ms) stats.over_budget++;
+}
+
+bool Checkpointer::Flush(EntityStore &store)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	written.wait(lock, [this] { return !writing; });
+	lock.unlock();
+
+	// A capture in progress or waiting is dropped, the full one replaces it.
+	capturing = false;
+	captured  = false;
+
+	Begin(store, true);
+	Scan(store, cursor);
+	Finish(store);
+
+	lock.lock();
+	written.wait(lock, [this] { return !writing; });
+	return last_ok;
+}
+
+// --- Writer thread -------------------------------------------------------
+
+void Checkpointer::Write()
+{
+#ifdef __linux__
+	// Per thread on Linux: the writer yields the CPU to the tick thread when
+	// they share one.
+	setpriority(PRIO_PROCESS, 0, 10);
+#endif
+
+	Compressor compressor(Compressor::Config{}, nullptr, 0);
+	compressor.SetChannelEnabled(0, true);
+
+	std::vector<uint8_t> payload;
+	while (true) {
+		Capture *capture;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return stopping || writing; });
+			if (!writing) return;
+			capture = writing;
+		}
+
+		auto	   start = Clock::now();
+		const bool ok	 = WriteFile(*capture, compressor, payload);
+		const auto ms	 = elapsed_ms(start);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (ok) {
+				(capture->full ? stats.full : stats.deltas)++;
+				stats.entities += capture->entities.size();
+				stats.bytes += HeaderSize + payload.size();
+			}
+			else
+				stats.write_errors++;
+			stats.write_ms_last = ms;
+			last_ok				= ok;
+			writing				= nullptr;
+		}
+		written.notify_all();
+	}
+}
+
+bool Checkpointer::WriteFile(Capture &capture, Compressor &compressor, std::vector<uint8_t> &payload)
+{
+	// A sliced capture may copy an entity twice, the later copy is newer.
+	auto &entities = capture.entities;
+	std::stable_sort(entities.begin(), entities.end(), [](const Entity &a, const Entity &b) { return a.id < b.id; });
+	size_t unique = 0;
+	for (size_t i = 0; i < entities.size(); i++) {
+		if (unique && entities[unique - 1].id == entities[i].id)
+			entities[unique - 1] = entities[i];
+		else
+			entities[unique++] = entities[i];
+	}
+	entities.resize(unique);
+
+	auto &removed = capture.removed;
+	std::sort(removed.begin(), removed.end());
+	removed.erase(std::unique(removed.begin(), removed.end()), removed.end());
+
+	std::vector<uint8_t> records;
+	records.reserve(entities.size() * 12 + removed.size() * 2);
+	uint32_t previous = 0;
+	for (const auto &entity : entities) {
+		put_varint(records, entity.id - previous);
+		put_varint(records, entity.type);
+		put_varint(records, entity.flags);
+		put_varint(records, zigzag(entity.position.x.raw));
+		put_varint(records, zigzag(entity.position.y.raw));
+		put_varint(records, zigzag(entity.velocity.x.raw));
+		put_varint(records, zigzag(entity.velocity.y.raw));
+		previous = entity.id;
+	}
+	previous = 0;
+	for (uint32_t id : removed) {
+		put_varint(records, id - previous);
+		previous = id;
+	}
+
+	if (!compressor.Encode(0, records.data(), records.size(), payload)) return false;
+
+	uint8_t header[HeaderSize] = {};
+	put_u32(header, Magic);
+	put_u16(header + 4, Version);
+	header[6] = capture.full ? KIND_FULL : KIND_DELTA;
+	put_u32(header + 8, capture.generation);
+	put_u32(header + 12, capture.index);
+	put_u64(header + 16, capture.since_tick);
+	put_u64(header + 24, capture.start_tick);
+	put_u64(header + 32, capture.end_tick);
+	put_u32(header + 40, capture.next_id);
+	put_u32(header + 44, static_cast<uint32_t>(entities.size()));
+	put_u32(header + 48, static_cast<uint32_t>(removed.size()));
+	put_u32(header + 52, static_cast<uint32_t>(payload.size()));
+	put_u32(header + 56, fnv1a(payload.data(), payload.size()));
+
+	const std::string path = checkpoint_path(config.directory, capture.index);
+	const std::string temp = path + ".tmp";
+	FILE			 *file = fopen(temp.c_str(), "wb");
+	if (!file) return false;
+	bool ok = fwrite(header, 1, HeaderSize, file) == HeaderSize
+		   && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+	ok = fclose(file) == 0 && ok;
+	if (!ok) {
+		remove(temp.c_str());
+		return false;
+	}
+
+	// Deltas of the previous full checkpoint go first: a crash before the
+	// rename leaves that one alone, still valid.
+	if (capture.full)
+		for (uint32_t index = 1; remove(checkpoint_path(config.directory, index).c_str()) == 0; index++) continue;
+
+	return rename(temp.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "entity_store.h"
+
+class Compressor;
+
+struct CheckpointStats
+{
+	uint64_t full;				// checkpoints written
+	uint64_t deltas;
+	uint64_t entities;			// entity records written
+	uint64_t bytes;				// file bytes written
+	uint64_t write_errors;
+	uint64_t deferred;			// ticks a finished capture waited for the writer
+	uint64_t capture_ticks;		// ticks that spent time capturing
+	uint64_t over_budget;		// of those, ticks over budget_ms
+	double	 capture_ms_max;	// worst capture time in a tick
+	double	 capture_ms_total;
+	double	 write_ms_last;		// background encode and write of the last checkpoint
+};
+
+// Periodic checkpoints of an EntityStore, so a restarted server resumes the
+// match.
+//
+// The store is copied on the tick thread into one of two buffers, in slices
+// that keep each tick's copy within budget_ms, while a background thread
+// encodes and writes the other buffer. Every full_every-th checkpoint is
+// full, the ones between are deltas holding entities changed and ids
+// despawned since the previous capture started.
+//
+// A sliced capture walks the store from the end: despawns swap the last
+// entity into the hole, which is then either already copied or still ahead.
+// Every entity alive through the capture is in it, each as of some tick
+// within the capture, and the next delta brings all of them up to date.
+//
+// Files, in `directory`:
+//
+//     full.ckpt              latest full checkpoint
+//     delta-0001.ckpt ...    deltas since, in order
+//
+// Each is a little-endian header, see checkpoint.cpp, followed by a payload
+// of varint coded records, compressed with zstd when that pays. Files are
+// written to a temporary name and renamed over, and deltas carry the
+// generation of their full checkpoint, so a crash at any point leaves a
+// consistent chain.
+class Checkpointer
+{
+   public:
+	static const uint32_t Magic	  = 0x4b434c4d;	 // "MLCK"
+	static const uint16_t Version = 1;
+
+	struct Config
+	{
+		std::string directory  = "checkpoints";
+		double		interval   = 5.0;  // seconds between checkpoint starts
+		int			full_every = 12;   // a full checkpoint, then full_every - 1 deltas
+		double		budget_ms  = 0.5;  // capture time per tick
+	};
+
+	struct RestoreInfo
+	{
+		uint32_t generation;
+		int		 deltas;  // applied after the full checkpoint
+		uint64_t tick;	  // store tick restored
+		double	 ms;
+	};
+
+	Checkpointer() : Checkpointer(Config{}) {}
+	explicit Checkpointer(const Config &config);
+	~Checkpointer();  // waits for a write in progress
+
+	Checkpointer(const Checkpointer &)			  = delete;
+	Checkpointer &operator=(const Checkpointer &) = delete;
+
+	// Loads the latest chain from the directory into `store`, replacing its
+	// contents, and continues numbering after it. False when there is no
+	// valid full checkpoint; deltas failing validation end the chain.
+	bool Restore(EntityStore &store, RestoreInfo *info = nullptr);
+
+	// Called once per tick: starts a checkpoint when due, continues a
+	// capture in progress, hands finished ones to the writer. Does not wait.
+	void Update(EntityStore &store, double time);
+
+	// Captures the whole store now, as a full checkpoint, and waits until it
+	// is written. For shutdown.
+	bool Flush(EntityStore &store);
+
+	bool			IsCapturing() const { return capturing; }
+	CheckpointStats GetStats() const;
+
+   private:
+	struct Capture
+	{
+		bool				  full;
+		uint32_t			  generation;
+		uint32_t			  index;  // 0 for full, then delta number
+		uint64_t			  since_tick;
+		uint64_t			  start_tick;
+		uint64_t			  end_tick;
+		uint32_t			  next_id;
+		std::vector<Entity>	  entities;
+		std::vector<uint32_t> removed;
+	};
+
+	Config config;
+
+	// Tick thread.
+	Capture	 buffers[2];
+	int		 filling;	 // buffer being captured into
+	bool	 capturing;
+	bool	 captured;	 // buffers[filling] done, waiting for the writer
+	size_t	 cursor;	 // entities at and past it are scanned
+	double	 next_due;
+	uint32_t generation;
+	uint32_t delta_index;
+	uint64_t last_start_tick;
+	double	 ns_per_entity[2];	// measured scan cost, for deltas and full ones
+
+	// Shared with the writer.
+	mutable std::mutex		mutex;
+	std::condition_variable wake;
+	std::condition_variable written;
+	Capture				   *writing;  // handed to the writer, nullptr when idle
+	bool					stopping;
+	bool					last_ok;
+	CheckpointStats			stats;
+	std::thread				writer;
+
+	void Begin(EntityStore &store, bool full);
+	void Scan(const EntityStore &store, size_t count);
+	void Finish(EntityStore &store);
+	bool HandOff();
+	void Write();
+	bool WriteFile(Capture &capture, Compressor &compressor, std::vector<uint8_t> &payload);
+};
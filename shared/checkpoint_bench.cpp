@@ -0,0 +1,113 @@
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "checkpoint.h"
+
+// Tick time with checkpointing against without, and what a blocking save
+// and a restore cost, for a large entity store.
+//
+//     checkpoint_bench [entities] [ticks] [budget ms]
+//
+// A quarter of the entities move every tick and a few spawn and despawn, at
+// 100 ticks per second with a checkpoint every half second, a full one every
+// fourth. Ticks are paced in real time like the server's, the writer thread
+// runs in the time between them. Checkpoints go to the system temporary
+// directory.
+
+static const double TickSeconds = 0.01;
+
+static void populate(EntityStore &store, int entities)
+{
+	for (int i = 0; i < entities; i++) {
+		const FixedVec2 position{Fixed::FromInt(i % 1000), Fixed::FromInt(i / 1000)};
+		const FixedVec2 velocity = i % 4 ? FixedVec2{} : FixedVec2{Fixed::FromInt(1), Fixed::FromRaw(-Fixed::One / 2)};
+		store.Spawn(static_cast<uint16_t>(i % 16), position, velocity);
+	}
+}
+
+static void churn(EntityStore &store, int tick)
+{
+	const Fixed dt = Fixed::FromFloat(static_cast<float>(TickSeconds));
+	store.Step(dt);
+	for (int i = 0; i < 4; i++) {
+		store.Despawn(static_cast<uint32_t>(tick * 4 + i + 1));
+		store.Spawn(3, FixedVec2{Fixed::FromInt(tick % 1000), Fixed::FromInt(i)});
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const int	 entities  = argc > 1 ? atoi(argv[1]) : 100000;
+	const int	 ticks	   = argc > 2 ? atoi(argv[2]) : 1000;
+	const double budget_ms = argc > 3 ? atof(argv[3]) : 0.5;
+
+	Bench bench("checkpoint_bench");
+
+	Checkpointer::Config config;
+	config.directory  = (std::filesystem::temp_directory_path() / "mlge_checkpoint_bench").string();
+	config.interval	  = 0.5;
+	config.full_every = 4;
+	config.budget_ms  = budget_ms;
+	std::filesystem::remove_all(config.directory);
+
+	auto run = [&](const char *name, Checkpointer *checkpointer, EntityStore &store) {
+		std::vector<double> tick_ms;
+		auto				next = Bench::Clock::now();
+		for (int tick = 0; tick < ticks; tick++) {
+			auto start = Bench::Clock::now();
+			churn(store, tick);
+			if (checkpointer) checkpointer->Update(store, tick * TickSeconds);
+			tick_ms.push_back(std::chrono::duration<double, std::milli>(Bench::Clock::now() - start).count());
+
+			next += std::chrono::duration_cast<Bench::Clock::duration>(std::chrono::duration<double>(TickSeconds));
+			std::this_thread::sleep_until(next);
+		}
+		bench.Record(name, tick_ms);
+	};
+
+	{
+		EntityStore store;
+		populate(store, entities);
+		run("tick", nullptr, store);
+	}
+
+	EntityStore store;
+	populate(store, entities);
+	{
+		Checkpointer checkpointer(config);
+		run("tick, checkpointing", &checkpointer, store);
+
+		const auto stats = checkpointer.GetStats();
+		bench.Counter("full checkpoints", stats.full);
+		bench.Counter("delta checkpoints", stats.deltas);
+		bench.Counter("bytes written", stats.bytes);
+		bench.Counter("entity records written", stats.entities);
+		bench.Counter("capture ticks", stats.capture_ticks);
+		bench.Counter("capture ticks over budget", stats.over_budget);
+		bench.Counter("capture ms, worst tick", stats.capture_ms_max);
+		bench.Counter("capture ms, mean tick", stats.capture_ticks ? stats.capture_ms_total / stats.capture_ticks : 0.0);
+		bench.Counter("ticks waiting for the writer", stats.deferred);
+		bench.Counter("write ms, background", stats.write_ms_last);
+
+		// What saving inline would stall a tick for.
+		bench.Run("blocking full save", 5, [&] { checkpointer.Flush(store); });
+	}
+
+	Checkpointer::RestoreInfo info{};
+	bench.Run("restore", 5, [&] {
+		Checkpointer checkpointer(config);
+		EntityStore	 restored;
+		checkpointer.Restore(restored, &info);
+	});
+
+	bench.Counter("entities", store.GetCount());
+	bench.Counter("budget ms", budget_ms);
+	bench.Counter("restored tick", static_cast<double>(info.tick));
+	bench.Print();
+
+	std::filesystem::remove_all(config.directory);
+	return info.tick == store.GetTick() ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+#include "checkpoint.h"
+
+#include "check.h"
+
+#include <cstdio>
+#include <filesystem>
+
+static std::string test_directory(const char *name)
+{
+	auto path = std::filesystem::temp_directory_path() / name;
+	std::filesystem::remove_all(path);
+	return path.string();
+}
+
+static bool same_entities(const EntityStore &a, const EntityStore &b)
+{
+	if (a.GetCount() != b.GetCount()) return false;
+	for (const auto &entity : a.GetEntities()) {
+		const Entity *other = b.Find(entity.id);
+		if (!other || other->type != entity.type || other->flags != entity.flags || other->position != entity.position
+			|| other->velocity != entity.velocity)
+			return false;
+	}
+	return true;
+}
+
+static FixedVec2 vec(int x, int y)
+{
+	return {Fixed::FromInt(x), Fixed::FromInt(y)};
+}
+
+static void test_store()
+{
+	EntityStore store;
+	uint32_t	a = store.Spawn(1, vec(0, 0), vec(1, 0));
+	uint32_t	b = store.Spawn(2, vec(5, 5));
+	uint32_t	c = store.Spawn(3, vec(9, 9));
+	CHECK(a == 1 && b == 2 && c == 3);
+
+	store.Step(Fixed::FromInt(1));
+	CHECK(store.GetTick() == 1);
+	CHECK(store.Find(a)->position == vec(1, 0));
+	CHECK(store.GetChangeTicks()[0] == 0);
+
+	CHECK(store.Despawn(a));
+	CHECK(!store.Despawn(a));
+	CHECK(!store.Find(a));
+	CHECK(store.GetCount() == 2);
+	CHECK(store.GetRemovals().size() == 1 && store.GetRemovals()[0].id == a);
+	CHECK(store.Spawn(1, vec(0, 0)) == 4);	 // ids are not reused
+
+	store.TrimRemovals(2);
+	CHECK(store.GetRemovals().empty());
+}
+
+// Full checkpoint, deltas with spawns, moves and despawns, then a restore.
+static void test_round_trip()
+{
+	Checkpointer::Config config;
+	config.directory  = test_directory("mlge_checkpoint_round_trip");
+	config.interval	  = 1.0;
+	config.full_every = 4;
+
+	EntityStore store;
+	for (int i = 0; i < 1000; i++) store.Spawn(i % 7, vec(i, -i), i % 3 ? vec(0, 0) : vec(1, -1));
+
+	{
+		Checkpointer checkpointer(config);
+		double		 time = 0.0;
+		for (int tick = 0; tick < 300; tick++, time += 0.1) {
+			store.Step(Fixed::FromInt(1) / Fixed::FromInt(10));
+			if (tick % 10 == 0) store.Despawn(static_cast<uint32_t>(tick + 1));
+			if (tick % 7 == 0) store.Spawn(9, vec(tick, tick));
+			if (Entity *entity = store.Modify(500)) entity->flags = static_cast<uint16_t>(tick);
+			checkpointer.Update(store, time);
+		}
+		while (checkpointer.IsCapturing()) checkpointer.Update(store, time);
+
+		const auto stats = checkpointer.GetStats();
+		CHECK(stats.full >= 2);
+		CHECK(stats.deltas >= 4);
+		CHECK(stats.write_errors == 0);
+	}
+
+	// Shutdown writes the current state.
+	{
+		Checkpointer checkpointer(config);
+		CHECK(checkpointer.Flush(store));
+	}
+	EntityStore				  restored;
+	Checkpointer::RestoreInfo info;
+	{
+		Checkpointer checkpointer(config);
+		CHECK(checkpointer.Restore(restored, &info));
+	}
+	CHECK(info.deltas == 0);
+	CHECK(info.tick == store.GetTick());
+	CHECK(same_entities(store, restored));
+	CHECK(restored.GetNextId() == store.GetNextId());
+}
+
+// Restoring a chain of deltas gives the store as of the last capture.
+static void test_deltas()
+{
+	Checkpointer::Config config;
+	config.directory  = test_directory("mlge_checkpoint_deltas");
+	config.interval	  = 1.0;
+	config.full_every = 100;
+
+	EntityStore store;
+	for (int i = 0; i < 200; i++) store.Spawn(1, vec(i, 0), i % 2 ? vec(1, 0) : vec(0, 0));
+
+	Checkpointer checkpointer(config);
+	double		 time	 = 0.0;
+	auto		 written = [&] { return checkpointer.GetStats().full + checkpointer.GetStats().deltas; };
+	auto		 checkpoint = [&] {
+		const auto before = written();
+		do checkpointer.Update(store, time);
+		while (checkpointer.IsCapturing());
+		while (written() == before) checkpointer.Update(store, time);
+		time += 1.0;
+	};
+	checkpoint();
+
+	for (int round = 0; round < 5; round++) {
+		store.Step(Fixed::FromInt(1));
+		store.Despawn(static_cast<uint32_t>(round * 3 + 1));
+		store.Spawn(2, vec(round, round));
+		checkpoint();
+	}
+	CHECK(checkpointer.GetStats().full == 1);
+	CHECK(checkpointer.GetStats().deltas == 5);
+
+	Checkpointer			  reader(config);
+	EntityStore				  restored;
+	Checkpointer::RestoreInfo info;
+	CHECK(reader.Restore(restored, &info));
+	CHECK(info.deltas == 5);
+	CHECK(same_entities(store, restored));
+
+	// A damaged delta ends the chain there.
+	{
+		FILE *file = fopen((config.directory + "/delta-0003.ckpt").c_str(), "r+b");
+		CHECK(file);
+		fseek(file, -1, SEEK_END);
+		const int last = fgetc(file);
+		fseek(file, -1, SEEK_END);
+		fputc(last ^ 0xff, file);
+		fclose(file);
+	}
+	CHECK(reader.Restore(restored, &info));
+	CHECK(info.deltas == 2);
+
+	// So does one claiming a payload larger than the file, without
+	// allocating for it.
+	{
+		FILE *file = fopen((config.directory + "/delta-0002.ckpt").c_str(), "r+b");
+		CHECK(file);
+		fseek(file, 52, SEEK_SET);
+		const uint8_t size[4] = {0xff, 0xff, 0xff, 0xff};
+		fwrite(size, 1, sizeof(size), file);
+		fclose(file);
+	}
+	CHECK(reader.Restore(restored, &info));
+	CHECK(info.deltas == 1);
+}
+
+// Sliced captures while entities despawn under the scan keep every entity
+// alive through the capture.
+static void test_sliced()
+{
+	Checkpointer::Config config;
+	config.directory  = test_directory("mlge_checkpoint_sliced");
+	config.interval	  = 1000.0;
+	config.budget_ms  = 0.0;  // smallest slices
+
+	EntityStore store;
+	for (int i = 0; i < 5000; i++) store.Spawn(1, vec(i, i));
+
+	Checkpointer checkpointer(config);
+	checkpointer.Update(store, 0.0);
+	CHECK(checkpointer.IsCapturing());
+
+	// Despawns from the front swap entities from the scanned end forward.
+	uint32_t next = 1;
+	while (checkpointer.IsCapturing()) {
+		store.Despawn(next++);
+		checkpointer.Update(store, 0.0);
+	}
+	while (checkpointer.GetStats().full == 0) checkpointer.Update(store, 0.0);
+	CHECK(checkpointer.GetStats().over_budget > 0);
+
+	Checkpointer reader(config);
+	EntityStore	 restored;
+	CHECK(reader.Restore(restored));
+	CHECK(same_entities(store, restored));
+}
+
+int main()
+{
+	test_store();
+	test_round_trip();
+	test_deltas();
+	test_sliced();
+	printf("checkpoint_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include "client_table.h"
+
+#include <algorithm>
+#include <cmath>
+
+ClientTable::ClientTable(const Config &config)
+	: config{config},
+	  slots(config.capacity),
+	  wheel(config.wheel_size, InvalidSlot),
+	  wheel_tick{-1}
+{
+	active.reserve(config.capacity);
+	free_slots.reserve(config.capacity);
+	by_id.reserve(config.capacity);
+	by_address.reserve(config.capacity);
+
+	// Lowest slots are handed out first.
+	for (int slot = config.capacity - 1; slot >= 0; slot--) {
+		slots[slot] = Slot{0, 0, 0.0, 0.0, -1, static_cast<int>(free_slots.size()), InvalidSlot, InvalidSlot, -1};
+		free_slots.push_back(slot);
+	}
+}
+
+bool ClientTable::Connect(int slot, uint64_t client_id, uint64_t address_key, double time)
+{
+	if (slot < 0 || slot >= config.capacity || IsConnected(slot)) return false;
+	if (by_id.count(client_id) || (address_key && by_address.count(address_key))) return false;
+
+	auto &entry = slots[slot];
+
+	const int moved				= free_slots.back();
+	free_slots[entry.free_index] = moved;
+	slots[moved].free_index		= entry.free_index;
+	free_slots.pop_back();
+	entry.free_index = -1;
+
+	entry.client_id	   = client_id;
+	entry.address_key  = address_key;
+	entry.last_seen	   = time;
+	entry.active_index = static_cast<int>(active.size());
+	active.push_back(slot);
+
+	by_id[client_id] = slot;
+	if (address_key) by_address[address_key] = slot;
+
+	Schedule(slot, time + config.idle_timeout);
+	return true;
+}
+
+void ClientTable::Disconnect(int slot)
+{
+	if (slot < 0 || slot >= config.capacity || !IsConnected(slot)) return;
+
+	auto &entry = slots[slot];
+	Unschedule(slot);
+
+	by_id.erase(entry.client_id);
+	if (entry.address_key) by_address.erase(entry.address_key);
+
+	const int moved				   = active.back();
+	active[entry.active_index]	   = moved;
+	slots[moved].active_index	   = entry.active_index;
+	active.pop_back();
+	entry.active_index = -1;
+
+	entry.free_index = static_cast<int>(free_slots.size());
+	free_slots.push_back(slot);
+}
+
+int ClientTable::FindById(uint64_t client_id) const
+{
+	auto it = by_id.find(client_id);
+	return it == by_id.end() ? InvalidSlot : it->second;
+}
+
+int ClientTable::FindByAddress(uint64_t address_key) const
+{
+	auto it = by_address.find(address_key);
+	return it == by_address.end() ? InvalidSlot : it->second;
+}
+
+// --- Timer wheel ---------------------------------------------------------
+
+int64_t ClientTable::TickOf(double time) const
+{
+	return static_cast<int64_t>(std::floor(time / config.resolution));
+}
+
+void ClientTable::Schedule(int slot, double deadline)
+{
+	// Never behind the wheel, or the entry would wait for a full turn.
+	const int64_t tick	 = std::max(TickOf(deadline), wheel_tick + 1);
+	const int	  bucket = static_cast<int>(tick % config.wheel_size);
+
+	auto &entry		 = slots[slot];
+	entry.deadline	 = deadline;
+	entry.bucket	 = bucket;
+	entry.wheel_prev = InvalidSlot;
+	entry.wheel_next = wheel[bucket];
+	if (wheel[bucket] != InvalidSlot) slots[wheel[bucket]].wheel_prev = slot;
+	wheel[bucket] = slot;
+}
+
+void ClientTable::Unschedule(int slot)
+{
+	auto &entry = slots[slot];
+	if (entry.bucket < 0) return;
+
+	if (entry.wheel_prev != InvalidSlot)
+		slots[entry.wheel_prev].wheel_next = entry.wheel_next;
+	else
+		wheel[entry.bucket] = entry.wheel_next;
+	if (entry.wheel_next != InvalidSlot) slots[entry.wheel_next].wheel_prev = entry.wheel_prev;
+
+	entry.bucket	 = -1;
+	entry.wheel_prev = entry.wheel_next = InvalidSlot;
+}
+
+void ClientTable::CollectExpired(double time, std::vector<int> &due)
+{
+	due.clear();
+
+	// Only buckets of completed ticks, every deadline in them is past. After a
+	// long stall each bucket is visited once.
+	const int64_t last	= TickOf(time) - 1;
+	const int64_t first = std::max(wheel_tick + 1, last - config.wheel_size + 1);
+
+	for (int64_t tick = first; tick <= last; tick++) {
+		int slot = wheel[tick % config.wheel_size];
+		while (slot != InvalidSlot) {
+			auto	 &entry = slots[slot];
+			const int next	= entry.wheel_next;
+
+			// Deadlines a turn or more ahead share the bucket, they stay.
+			if (entry.deadline <= time) {
+				Unschedule(slot);
+				if (entry.last_seen + config.idle_timeout > time)
+					Schedule(slot, entry.last_seen + config.idle_timeout);
+				else
+					due.push_back(slot);
+			}
+			slot = next;
+		}
+	}
+	wheel_tick = std::max(wheel_tick, last);
+
+	// Expired clients that stay connected are checked again a timeout later.
+	for (int slot : due) Schedule(slot, time + config.idle_timeout);
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Connection slots sized for thousands of mostly idle clients.
+//
+// Clients are found by id or address key through hash indices, per-tick work
+// walks a dense list of connected slots instead of every slot, and idle
+// timeouts come from a hashed timer wheel, so a tick costs nothing for slots
+// that are neither connected nor due.
+//
+// Touch() only records activity: an entry whose deadline comes up while the
+// client has been active since is rescheduled then, which keeps the per-packet
+// path free of wheel updates.
+class ClientTable
+{
+   public:
+	static constexpr int InvalidSlot = -1;
+
+	struct Config
+	{
+		int	   capacity		= 1024;
+		double idle_timeout = 300.0;  // seconds without Touch()
+		double resolution	= 0.1;	  // seconds per wheel bucket
+		int	   wheel_size	= 512;	  // buckets, a full turn covers resolution * wheel_size
+	};
+
+	ClientTable() : ClientTable(Config{}) {}
+	explicit ClientTable(const Config &config);
+
+	// Free slot for transports that leave slot allocation to the table,
+	// InvalidSlot when full.
+	int Acquire() const { return free_slots.empty() ? InvalidSlot : free_slots.back(); }
+
+	// address_key 0 means the client is not indexed by address.
+	bool Connect(int slot, uint64_t client_id, uint64_t address_key, double time);
+	void Disconnect(int slot);
+	void Touch(int slot, double time) { slots[slot].last_seen = time; }
+
+	int FindById(uint64_t client_id) const;
+	int FindByAddress(uint64_t address_key) const;
+
+	bool	 IsConnected(int slot) const { return slots[slot].active_index >= 0; }
+	uint64_t GetClientId(int slot) const { return slots[slot].client_id; }
+	double	 GetLastSeen(int slot) const { return slots[slot].last_seen; }
+
+	// Connected slots, in no particular order. Disconnect() reorders it.
+	const std::vector<int> &GetActive() const { return active; }
+	int						GetActiveCount() const { return static_cast<int>(active.size()); }
+	int						GetCapacity() const { return config.capacity; }
+
+	// Calls expire(slot) for every client idle for idle_timeout at `time`.
+	// The slot is still connected during the call and may be disconnected
+	// from it.
+	template <typename Expire>
+	int ExpireTimeouts(double time, Expire &&expire)
+	{
+		CollectExpired(time, expired);
+		for (int slot : expired) expire(slot);
+		return static_cast<int>(expired.size());
+	}
+
+   private:
+	struct Slot
+	{
+		uint64_t client_id;
+		uint64_t address_key;
+		double	 last_seen;
+		double	 deadline;
+		int		 active_index;	// in active, -1 when free
+		int		 free_index;	// in free_slots, -1 when taken
+		int		 wheel_prev, wheel_next;
+		int		 bucket;  // -1 when not scheduled
+	};
+
+	Config							 config;
+	std::vector<Slot>				 slots;
+	std::vector<int>				 active;
+	std::vector<int>				 free_slots;
+	std::unordered_map<uint64_t, int> by_id;
+	std::unordered_map<uint64_t, int> by_address;
+
+	std::vector<int> wheel;	 // head slot per bucket
+	int64_t			 wheel_tick;
+	std::vector<int> expired;
+
+	int64_t TickOf(double time) const;
+	void	Schedule(int slot, double deadline);
+	void	Unschedule(int slot);
+	void	CollectExpired(double time, std::vector<int> &due);
+};
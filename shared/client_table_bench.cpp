@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "bench.h"
+#include "client_table.h"
+
+// Per-tick server overhead with many mostly idle connections: the client
+// table against scanning every slot, as a fixed client array does.
+//
+//     client_table_bench [connections] [slots] [ticks]
+//
+// Each tick a few clients send a packet (looked up by address), one client
+// leaves and another joins, every connected client gets its per-tick update
+// and idle clients are timed out.
+
+static const double TickSeconds	 = 0.01;
+static const double IdleTimeout	 = 5.0;
+static const int	SendersPerTick = 2;
+
+// Slot array scanned every tick, clients found by a linear address search.
+struct ScanTable
+{
+	struct Slot
+	{
+		bool	 connected;
+		uint64_t client_id;
+		uint64_t address;
+		double	 last_seen;
+	};
+	std::vector<Slot> slots;
+
+	int Find(uint64_t address) const
+	{
+		for (size_t i = 0; i < slots.size(); i++)
+			if (slots[i].connected && slots[i].address == address) return static_cast<int>(i);
+		return -1;
+	}
+	int FindFree() const
+	{
+		for (size_t i = 0; i < slots.size(); i++)
+			if (!slots[i].connected) return static_cast<int>(i);
+		return -1;
+	}
+};
+
+static uint64_t address_of(uint64_t client_id)
+{
+	return client_id * 0x9e3779b97f4a7c15ull | 1;
+}
+
+int main(int argc, char *argv[])
+{
+	const int connections = argc > 1 ? atoi(argv[1]) : 1000;
+	const int capacity	  = argc > 2 ? atoi(argv[2]) : 4096;
+	const int ticks		  = argc > 3 ? atoi(argv[3]) : 3000;
+
+	Bench	 bench("client_table_bench");
+	uint64_t updates = 0;  // per-client work, kept observable
+
+	// Both runs see the same clients, senders and churn.
+	uint32_t seed	= 1;
+	auto	 random = [&] { return seed = seed * 1664525u + 1013904223u; };
+
+	{
+		ScanTable table{std::vector<ScanTable::Slot>(capacity)};
+		uint64_t  next_id = 1;
+		for (int i = 0; i < connections; i++, next_id++) table.slots[i] = {true, next_id, address_of(next_id), 0.0};
+
+		seed = 1;
+		std::vector<double> tick_ms;
+		for (int tick = 0; tick < ticks; tick++) {
+			const double time  = tick * TickSeconds;
+			auto		 start = Bench::Clock::now();
+
+			for (int i = 0; i < SendersPerTick; i++) {
+				const int slot = table.Find(address_of(next_id - 1 - random() % connections));
+				if (slot >= 0) table.slots[slot].last_seen = time;
+			}
+
+			const int leaving = table.Find(address_of(next_id - connections));
+			if (leaving >= 0) table.slots[leaving].connected = false;
+			const int joining = table.FindFree();
+			table.slots[joining] = {true, next_id, address_of(next_id), time};
+			next_id++;
+
+			for (auto &slot : table.slots) {
+				if (!slot.connected) continue;
+				updates++;
+				if (time - slot.last_seen > IdleTimeout) slot.connected = false;
+			}
+
+			tick_ms.push_back(std::chrono::duration<double, std::milli>(Bench::Clock::now() - start).count());
+		}
+		bench.Record("tick, slot scan", tick_ms);
+		bench.Counter("connected at end, slot scan",
+					  std::count_if(table.slots.begin(), table.slots.end(), [](const ScanTable::Slot &slot) { return slot.connected; }));
+	}
+
+	{
+		ClientTable::Config config;
+		config.capacity		= capacity;
+		config.idle_timeout = IdleTimeout;
+		ClientTable table(config);
+
+		uint64_t next_id = 1;
+		for (int i = 0; i < connections; i++, next_id++) table.Connect(table.Acquire(), next_id, address_of(next_id), 0.0);
+
+		seed = 1;
+		std::vector<double> tick_ms;
+		int					expired = 0;
+		for (int tick = 0; tick < ticks; tick++) {
+			const double time  = tick * TickSeconds;
+			auto		 start = Bench::Clock::now();
+
+			for (int i = 0; i < SendersPerTick; i++) {
+				const int slot = table.FindByAddress(address_of(next_id - 1 - random() % connections));
+				if (slot >= 0) table.Touch(slot, time);
+			}
+
+			table.Disconnect(table.FindByAddress(address_of(next_id - connections)));
+			table.Connect(table.Acquire(), next_id, address_of(next_id), time);
+			next_id++;
+
+			for (int slot : table.GetActive()) updates += table.GetClientId(slot) != 0;
+			expired += table.ExpireTimeouts(time, [&](int slot) { table.Disconnect(slot); });
+
+			tick_ms.push_back(std::chrono::duration<double, std::milli>(Bench::Clock::now() - start).count());
+		}
+		bench.Record("tick, client table", tick_ms);
+		bench.Counter("connected at end, client table", table.GetActiveCount());
+		bench.Counter("timed out, client table", expired);
+	}
+
+	bench.Counter("connections", connections);
+	bench.Counter("slots", capacity);
+	bench.Counter("client updates / tick", double(updates) / ticks / 2);
+	bench.Print();
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+#include "client_table.h"
+
+#include "check.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static ClientTable::Config config(int capacity)
+{
+	ClientTable::Config config;
+	config.capacity		= capacity;
+	config.idle_timeout = 10.0;
+	config.resolution	= 0.1;
+	config.wheel_size	= 32;  // a turn is shorter than the timeout
+	return config;
+}
+
+static void test_slots()
+{
+	ClientTable table(config(4));
+
+	CHECK(table.Acquire() == 0);
+	CHECK(table.Connect(0, 100, 0xa0, 0.0));
+	CHECK(table.Acquire() == 1);
+	CHECK(table.Connect(2, 102, 0xa2, 0.0));  // transport chosen slot
+	CHECK(!table.Connect(2, 103, 0, 0.0));	   // taken
+	CHECK(!table.Connect(3, 100, 0, 0.0));	   // duplicate id
+	CHECK(!table.Connect(3, 103, 0xa0, 0.0)); // duplicate address
+	CHECK(table.Connect(table.Acquire(), 101, 0, 0.0));
+	CHECK(table.Connect(table.Acquire(), 103, 0, 0.0));
+	CHECK(table.Acquire() == ClientTable::InvalidSlot);
+
+	CHECK(table.FindById(102) == 2);
+	CHECK(table.FindByAddress(0xa2) == 2);
+	CHECK(table.FindById(999) == ClientTable::InvalidSlot);
+	CHECK(table.FindByAddress(0) == ClientTable::InvalidSlot);
+
+	table.Disconnect(2);
+	CHECK(!table.IsConnected(2));
+	CHECK(table.FindById(102) == ClientTable::InvalidSlot);
+	CHECK(table.FindByAddress(0xa2) == ClientTable::InvalidSlot);
+	CHECK(table.GetActiveCount() == 3);
+	CHECK(std::find(table.GetActive().begin(), table.GetActive().end(), 2) == table.GetActive().end());
+	CHECK(table.Acquire() == 2);
+}
+
+static void test_timeouts()
+{
+	ClientTable table(config(64));
+	for (int slot = 0; slot < 64; slot++) table.Connect(slot, slot + 1, 0, slot * 0.05);
+
+	// Even slots keep talking, odd ones go quiet.
+	std::vector<int> expired_at(64, -1);
+	for (int step = 0; step <= 400; step++) {
+		const double time = step * 0.05;
+		for (int slot : table.GetActive())
+			if (slot % 2 == 0) table.Touch(slot, time);
+
+		table.ExpireTimeouts(time, [&](int slot) {
+			expired_at[slot] = step;
+			table.Disconnect(slot);
+		});
+	}
+
+	for (int slot = 0; slot < 64; slot++) {
+		if (slot % 2 == 0) {
+			CHECK(table.IsConnected(slot));
+			CHECK(expired_at[slot] == -1);
+		}
+		else {
+			// Within one bucket after the deadline, never before it.
+			const double deadline = slot * 0.05 + 10.0;
+			CHECK(expired_at[slot] * 0.05 >= deadline);
+			CHECK(expired_at[slot] * 0.05 <= deadline + 0.1 + 0.05);
+			CHECK(!table.IsConnected(slot));
+		}
+	}
+	CHECK(table.GetActiveCount() == 32);
+}
+
+// After a stall longer than a wheel turn every due client still expires.
+static void test_stall()
+{
+	ClientTable table(config(8));
+	for (int slot = 0; slot < 8; slot++) table.Connect(slot, slot + 1, 0, 0.0);
+	table.Touch(3, 15.0);
+
+	std::vector<int> expired;
+	CHECK(table.ExpireTimeouts(20.0, [&](int slot) { expired.push_back(slot); }) == 7);
+	CHECK(std::find(expired.begin(), expired.end(), 3) == expired.end());
+
+	// Left connected, they come up again a timeout later.
+	CHECK(table.ExpireTimeouts(25.15, [](int) {}) == 1);  // slot 3, one bucket late at most
+	CHECK(table.ExpireTimeouts(29.95, [](int) {}) == 0);
+	CHECK(table.ExpireTimeouts(30.2, [](int) {}) == 7);
+}
+
+int main()
+{
+	test_slots();
+	test_timeouts();
+	test_stall();
+	printf("client_table_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "compress.h"
+
+#include <zstd.h>
+
+#include <chrono>
+#include <cstring>
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t elapsed_ns(Clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+Compressor::Compressor(const Config &config, const void *dictionary, size_t dictionary_size)
+	: config{config},
+	  channels{},
+	  cctx{ZSTD_createCCtx()},
+	  dctx{ZSTD_createDCtx()},
+	  cdict{ZSTD_createCDict(dictionary, dictionary_size, config.level)},
+	  ddict{ZSTD_createDDict(dictionary, dictionary_size)},
+	  stats{}
+{
+}
+
+Compressor::~Compressor()
+{
+	ZSTD_freeDDict(ddict);
+	ZSTD_freeCDict(cdict);
+	ZSTD_freeDCtx(dctx);
+	ZSTD_freeCCtx(cctx);
+}
+
+size_t Compressor::GetMaxEncodedSize(size_t size)
+{
+	return 1 + ZSTD_compressBound(size);
+}
+
+bool Compressor::Encode(int channel, const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+{
+	// Counted once encoded, failures would skew the ratio.
+	auto count = [&]() {
+		stats.messages++;
+		stats.bytes_in += size;
+		stats.bytes_out += out.size();
+		return true;
+	};
+
+	auto store_raw = [&]() {
+		out.resize(1 + size);
+		out[0] = CODEC_RAW;
+		if (size) memcpy(&out[1], data, size);
+		return count();
+	};
+
+	if (!IsChannelEnabled(channel) || size < static_cast<size_t>(config.threshold) || !cctx || !cdict)
+		return store_raw();
+
+	auto start = Clock::now();
+
+	out.resize(GetMaxEncodedSize(size));
+	size_t result = ZSTD_compress_usingCDict(cctx, &out[1], out.size() - 1, data, size, cdict);
+
+	stats.compress_ns += elapsed_ns(start);
+
+	if (ZSTD_isError(result)) return false;
+	if (result >= size) return store_raw();
+
+	out[0] = CODEC_ZSTD;
+	out.resize(1 + result);
+	stats.compressed++;
+	return count();
+}
+
+bool Compressor::Decode(const uint8_t *data, size_t size, std::vector<uint8_t> &out)
+{
+	if (size < 1) return false;
+
+	switch (data[0]) {
+		case CODEC_RAW:
+			if (size - 1 > config.max_decoded_size) return false;
+			out.assign(data + 1, data + size);
+			return true;
+
+		case CODEC_ZSTD: {
+			if (!dctx || !ddict) return false;
+
+			unsigned long long content_size = ZSTD_getFrameContentSize(data + 1, size - 1);
+			if (content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size == ZSTD_CONTENTSIZE_ERROR
+				|| content_size > config.max_decoded_size)
+				return false;
+
+			auto start = Clock::now();
+
+			out.resize(content_size);
+			size_t result = ZSTD_decompress_usingDDict(dctx, out.data(), out.size(), data + 1, size - 1, ddict);
+
+			stats.decompress_ns += elapsed_ns(start);
+
+			return !ZSTD_isError(result) && result == content_size;
+		}
+	}
+	return false;
+}
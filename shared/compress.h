@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+// Dictionary bundled with the shared library, see compress_dict.cpp.
+extern const unsigned char *const compress_dictionary;
+extern const size_t				  compress_dictionary_size;
+
+struct CompressionStats
+{
+	uint64_t messages;		   // payloads that went through Encode()
+	uint64_t compressed;	   // payloads stored compressed
+	uint64_t bytes_in;		   // raw payload bytes
+	uint64_t bytes_out;		   // encoded bytes, including the codec byte
+	uint64_t compress_ns;	   // CPU time spent compressing
+	uint64_t decompress_ns;	   // CPU time spent decompressing
+
+	double GetRatio() const { return bytes_out ? double(bytes_in) / double(bytes_out) : 1.0; }
+};
+
+// Dictionary compression of bulk payloads.
+//
+// Encoded payloads start with a codec byte, so the receiving side does not
+// need to know whether the sender compressed: payloads below the threshold,
+// on channels with compression disabled, or that would not shrink are
+// stored raw.
+class Compressor
+{
+   public:
+	enum Codec : uint8_t {
+		CODEC_RAW  = 0,
+		CODEC_ZSTD = 1,
+	};
+
+	static const int MaxChannels = 64;
+
+	struct Config
+	{
+		int	   threshold		= 256;		  // bytes, smaller payloads are not worth the CPU
+		int	   level			= 3;
+		size_t max_decoded_size = 16 << 20;	  // bytes, larger frames are rejected before allocating
+	};
+
+	Compressor() : Compressor(Config{}) {}
+	explicit Compressor(const Config &config, const void *dictionary = compress_dictionary, size_t dictionary_size = compress_dictionary_size);
+	~Compressor();
+
+	Compressor(const Compressor &)			  = delete;
+	Compressor &operator=(const Compressor &) = delete;
+
+	// Channels outside [0, MaxChannels) are never compressed.
+	void SetChannelEnabled(int channel, bool enabled)
+	{
+		if (channel >= 0 && channel < MaxChannels) channels[channel] = enabled;
+	}
+	bool IsChannelEnabled(int channel) const { return channel >= 0 && channel < MaxChannels && channels[channel]; }
+
+	static size_t GetMaxEncodedSize(size_t size);
+
+	// Encodes into `out`, returns false on internal compressor failure.
+	bool Encode(int channel, const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+	// Decodes into `out`, returns false on malformed input or past
+	// max_decoded_size.
+	bool Decode(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+
+	const CompressionStats &GetStats() const { return stats; }
+
+   private:
+	Config			 config;
+	bool			 channels[MaxChannels];
+	ZSTD_CCtx_s		*cctx;
+	ZSTD_DCtx_s		*dctx;
+	ZSTD_CDict_s	*cdict;
+	ZSTD_DDict_s	*ddict;
+	CompressionStats stats;
+};
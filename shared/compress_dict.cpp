@@ -0,0 +1,34 @@
+#include "compress.h"
+
+// Raw-content zstd dictionary for reliable bulk payloads: level data,
+// inventories, chat history and RML/RCSS markup.
+//
+// zstd uses it as a shared prefix, so it should hold the byte sequences that
+// recur across payloads, most frequent ones last. To replace it with a
+// trained one, capture payloads and run
+//
+//     zstd --train payloads/* --maxdict=4096 -o bulk.dict
+//
+// then regenerate the array below from bulk.dict (e.g. with `xxd -i`).
+// Both endpoints must use the same dictionary.
+
+// clang-format off
+static const char dictionary[] =
+	"<rml><head><link type=\"text/css\" href=\"\"/><title></title><style></style></head>"
+	"<body class=\"window\"><div id=\"\" class=\"\"></div><p></p><span></span>"
+	"<input type=\"text\" name=\"\" value=\"\"/><button></button></body></rml>"
+	"font-family: Press Start 2P; font-weight: normal; font-style: normal; font-size: dp; "
+	"color: white; display: block; width: height: margin: auto; padding: decorator: "
+	"position: absolute; left: top: right: bottom: background-color: border: "
+	"{\"level\":{\"name\":\"\",\"width\":,\"height\":,\"tiles\":[],\"spawns\":[],\"entities\":[]}}"
+	"{\"x\":,\"y\":,\"type\":\"\",\"id\":,\"layer\":,\"sprite\":\"\",\"frame\":,\"rotation\":}"
+	"{\"inventory\":{\"owner\":,\"slots\":[],\"items\":[{\"id\":,\"item\":\"\",\"count\":,\"slot\":,"
+	"\"durability\":,\"equipped\":false,\"equipped\":true}]}}"
+	"{\"chat\":[{\"channel\":\"all\",\"channel\":\"team\",\"from\":\"\",\"time\":,\"text\":\"\"}]}"
+	"\"score\":,\"health\":,\"ammo\":,\"lives\":,\"wave\":,\"player\":,\"team\":,\"name\":\""
+	"0000000000000000000000000000000000000000000000000000000000000000"
+	"\"},{\"id\":,\"x\":0,\"y\":0,\"type\":\"invader\",\"sprite\":\"assets/invader.tga\",\"layer\":0,";
+// clang-format on
+
+const unsigned char *const compress_dictionary	  = reinterpret_cast<const unsigned char *>(dictionary);
+const size_t			   compress_dictionary_size = sizeof(dictionary) - 1;
@@ -0,0 +1,123 @@
+#include "compress.h"
+
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static std::vector<uint8_t> bytes(const std::string &text)
+{
+	return std::vector<uint8_t>(text.begin(), text.end());
+}
+
+static std::string inventory(int items)
+{
+	std::string text = "{\"inventory\":{\"owner\":7,\"items\":[";
+	for (int i = 0; i < items; ++i)
+		text += "{\"id\":" + std::to_string(i) + ",\"item\":\"arrow\",\"count\":" + std::to_string(i % 20) + ",\"slot\":" + std::to_string(i) + ",\"equipped\":false},";
+	text += "]}}";
+	return text;
+}
+
+static void test_roundtrip()
+{
+	Compressor compressor;
+	compressor.SetChannelEnabled(0, true);
+
+	auto				 input = bytes(inventory(100));
+	std::vector<uint8_t> encoded, decoded;
+
+	CHECK(compressor.Encode(0, input.data(), input.size(), encoded));
+	CHECK(encoded[0] == Compressor::CODEC_ZSTD);
+	CHECK(encoded.size() * 4 < input.size());
+
+	CHECK(compressor.Decode(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded == input);
+
+	const auto &stats = compressor.GetStats();
+	CHECK(stats.messages == 1 && stats.compressed == 1);
+	CHECK(stats.bytes_in == input.size() && stats.bytes_out == encoded.size());
+	CHECK(stats.GetRatio() > 4.0);
+}
+
+static void test_stored_raw()
+{
+	Compressor compressor;
+	compressor.SetChannelEnabled(0, true);
+
+	std::vector<uint8_t> encoded, decoded;
+
+	// below the threshold
+	auto small = bytes("{\"chat\":[]}");
+	CHECK(compressor.Encode(0, small.data(), small.size(), encoded));
+	CHECK(encoded[0] == Compressor::CODEC_RAW && encoded.size() == small.size() + 1);
+	CHECK(compressor.Decode(encoded.data(), encoded.size(), decoded) && decoded == small);
+
+	// channel without compression
+	auto large = bytes(inventory(100));
+	CHECK(compressor.Encode(1, large.data(), large.size(), encoded));
+	CHECK(encoded[0] == Compressor::CODEC_RAW);
+	CHECK(compressor.Decode(encoded.data(), encoded.size(), decoded) && decoded == large);
+
+	// incompressible
+	std::vector<uint8_t> noise(4096);
+	uint32_t			 seed = 1;
+	for (auto &byte : noise) byte = (seed = seed * 1664525u + 1013904223u) >> 24;
+	CHECK(compressor.Encode(0, noise.data(), noise.size(), encoded));
+	CHECK(encoded[0] == Compressor::CODEC_RAW);
+
+	CHECK(compressor.GetStats().compressed == 0);
+}
+
+static void test_malformed()
+{
+	Compressor			 compressor;
+	std::vector<uint8_t> decoded;
+
+	const uint8_t empty[]	  = {0};
+	const uint8_t bad_codec[] = {42, 1, 2, 3};
+	const uint8_t bad_frame[] = {Compressor::CODEC_ZSTD, 1, 2, 3};
+
+	CHECK(compressor.Decode(empty, sizeof(empty), decoded) && decoded.empty());
+	CHECK(!compressor.Decode(empty, 0, decoded));
+	CHECK(!compressor.Decode(bad_codec, sizeof(bad_codec), decoded));
+	CHECK(!compressor.Decode(bad_frame, sizeof(bad_frame), decoded));
+}
+
+static void test_limits()
+{
+	Compressor::Config config;
+	config.max_decoded_size = 4096;
+	Compressor compressor(config);
+	compressor.SetChannelEnabled(0, true);
+
+	// The frame header claims more than the limit, rejected before allocating.
+	std::vector<uint8_t> large(8192, 'a'), encoded, decoded;
+	CHECK(compressor.Encode(0, large.data(), large.size(), encoded) && encoded[0] == Compressor::CODEC_ZSTD);
+	CHECK(encoded.size() < 4096);
+	CHECK(!compressor.Decode(encoded.data(), encoded.size(), decoded) && decoded.empty());
+
+	std::vector<uint8_t> raw(4098, Compressor::CODEC_RAW);
+	CHECK(!compressor.Decode(raw.data(), raw.size(), decoded));
+	raw.resize(4097);
+	CHECK(compressor.Decode(raw.data(), raw.size(), decoded) && decoded.size() == 4096);
+
+	// Channels out of range are stored raw.
+	compressor.SetChannelEnabled(-1, true);
+	compressor.SetChannelEnabled(Compressor::MaxChannels, true);
+	CHECK(!compressor.IsChannelEnabled(-1) && !compressor.IsChannelEnabled(Compressor::MaxChannels));
+	CHECK(compressor.Encode(Compressor::MaxChannels, large.data(), large.size(), encoded));
+	CHECK(encoded[0] == Compressor::CODEC_RAW);
+}
+
+int main()
+{
+	test_roundtrip();
+	test_stored_raw();
+	test_malformed();
+	test_limits();
+
+	printf("compress: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,101 @@
+#include "entity_store.h"
+
+#include <algorithm>
+
+uint32_t EntityStore::Spawn(uint16_t type, FixedVec2 position, FixedVec2 velocity)
+{
+	const uint32_t id = next_id++;
+	index[id]		  = static_cast<int>(entities.size());
+	entities.push_back({id, type, 0, position, velocity});
+	changed.push_back(tick);
+	return id;
+}
+
+bool EntityStore::Despawn(uint32_t id)
+{
+	auto it = index.find(id);
+	if (it == index.end()) return false;
+
+	removals.push_back({id, tick});
+	Remove(it->second);
+	return true;
+}
+
+// Swap-removes, the moved entity counts as changed: it is somewhere else in
+// the array now, which a checkpoint scanning the array may have to know.
+void EntityStore::Remove(int at)
+{
+	index.erase(entities[at].id);
+
+	const int last = static_cast<int>(entities.size()) - 1;
+	if (at != last) {
+		entities[at]			  = entities[last];
+		changed[at]				  = tick;
+		index[entities[at].id] = at;
+	}
+	entities.pop_back();
+	changed.pop_back();
+}
+
+const Entity *EntityStore::Find(uint32_t id) const
+{
+	auto it = index.find(id);
+	return it == index.end() ? nullptr : &entities[it->second];
+}
+
+Entity *EntityStore::Modify(uint32_t id)
+{
+	auto it = index.find(id);
+	if (it == index.end()) return nullptr;
+
+	changed[it->second] = tick;
+	return &entities[it->second];
+}
+
+void EntityStore::Step(Fixed dt)
+{
+	for (size_t i = 0; i < entities.size(); i++) {
+		auto &entity = entities[i];
+		if (entity.velocity.x.raw == 0 && entity.velocity.y.raw == 0) continue;
+
+		entity.position += entity.velocity * dt;
+		changed[i] = tick;
+	}
+	tick++;
+}
+
+void EntityStore::TrimRemovals(uint64_t tick)
+{
+	auto end = std::find_if(removals.begin(), removals.end(), [tick](const Removal &removal) { return removal.tick >= tick; });
+	removals.erase(removals.begin(), end);
+}
+
+void EntityStore::Put(const Entity &entity)
+{
+	auto it = index.find(entity.id);
+	if (it != index.end()) {
+		entities[it->second] = entity;
+		return;
+	}
+
+	index[entity.id] = static_cast<int>(entities.size());
+	entities.push_back(entity);
+	changed.push_back(tick);
+	next_id = std::max(next_id, entity.id + 1);
+}
+
+void EntityStore::Erase(uint32_t id)
+{
+	auto it = index.find(id);
+	if (it != index.end()) Remove(it->second);
+}
+
+void EntityStore::Clear()
+{
+	entities.clear();
+	changed.clear();
+	index.clear();
+	removals.clear();
+	tick	= 0;
+	next_id = 1;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "fixed.h"
+
+struct Entity
+{
+	uint32_t  id;
+	uint16_t  type;
+	uint16_t  flags;
+	FixedVec2 position;
+	FixedVec2 velocity;
+};
+
+// Simulation entities in a dense array, with the tick each one last changed
+// and a log of despawns, so a checkpoint can pick what changed since the
+// previous one. Ids are never reused.
+//
+// Entities are only changed through the store: Modify() for game code,
+// Step() for movement, so change ticks stay exact.
+class EntityStore
+{
+   public:
+	struct Removal
+	{
+		uint32_t id;
+		uint64_t tick;
+	};
+
+	uint32_t Spawn(uint16_t type, FixedVec2 position, FixedVec2 velocity = {});
+	bool	 Despawn(uint32_t id);
+
+	const Entity *Find(uint32_t id) const;
+	// Marks the entity changed this tick, nullptr for unknown ids.
+	Entity *Modify(uint32_t id);
+
+	// Moves every entity by its velocity over `dt`, and advances the tick.
+	void Step(Fixed dt);
+
+	uint64_t GetTick() const { return tick; }
+	uint32_t GetNextId() const { return next_id; }
+	int		 GetCount() const { return static_cast<int>(entities.size()); }
+
+	const std::vector<Entity>	&GetEntities() const { return entities; }
+	const std::vector<uint64_t> &GetChangeTicks() const { return changed; }	 // parallel to GetEntities()
+	const std::vector<Removal>	&GetRemovals() const { return removals; }	 // by tick
+
+	// Forgets despawns before `tick`, once no checkpoint needs them.
+	void TrimRemovals(uint64_t tick);
+
+	// Restore side: entities and counters as saved, not logged as changes.
+	void Put(const Entity &entity);
+	void Erase(uint32_t id);
+	void SetTick(uint64_t tick) { this->tick = tick; }
+	void SetNextId(uint32_t next_id) { this->next_id = next_id; }
+	void Clear();
+
+   private:
+	std::vector<Entity>				  entities;
+	std::vector<uint64_t>			  changed;
+	std::unordered_map<uint32_t, int> index;  // id to entities index
+	std::vector<Removal>			  removals;
+	uint64_t						  tick	  = 0;
+	uint32_t						  next_id = 1;
+
+	void Remove(int at);
+};
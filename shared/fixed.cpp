@@ -0,0 +1,164 @@
+#include "fixed.h"
+
+#include <cmath>
+
+Fixed Fixed::FromFloat(float value)
+{
+	return FromRaw(static_cast<int32_t>(std::lround(static_cast<double>(value) * One)));
+}
+
+Fixed fixed_abs(Fixed value)
+{
+	return value.raw < 0 ? -value : value;
+}
+
+Fixed fixed_min(Fixed a, Fixed b)
+{
+	return a < b ? a : b;
+}
+
+Fixed fixed_max(Fixed a, Fixed b)
+{
+	return a < b ? b : a;
+}
+
+Fixed fixed_clamp(Fixed value, Fixed min, Fixed max)
+{
+	return fixed_min(fixed_max(value, min), max);
+}
+
+// Bitwise integer square root, rounds down.
+static uint64_t isqrt(uint64_t value)
+{
+	uint64_t remainder = value;
+	uint64_t root	   = 0;
+	uint64_t bit	   = uint64_t(1) << 62;
+	while (bit > remainder) bit >>= 2;
+	while (bit) {
+		if (remainder >= root + bit) {
+			remainder -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return root;
+}
+
+Fixed fixed_sqrt(Fixed value)
+{
+	if (value.raw <= 0) return Fixed::FromRaw(0);
+	return Fixed::FromRaw(static_cast<int32_t>(isqrt(static_cast<uint64_t>(value.raw) << Fixed::FractionBits)));
+}
+
+int64_t FixedVec2::Dot(FixedVec2 other) const
+{
+	// Each product is within [-2^62, 2^62], so only a positive sum overflows.
+	const int64_t a = static_cast<int64_t>(x.raw) * other.x.raw;
+	const int64_t b = static_cast<int64_t>(y.raw) * other.y.raw;
+	if (b > 0 && a > INT64_MAX - b) return INT64_MAX;
+	return a + b;
+}
+
+uint64_t FixedVec2::LengthSquared() const
+{
+	// At most 2^63, at (-32768, -32768).
+	return static_cast<uint64_t>(static_cast<int64_t>(x.raw) * x.raw) + static_cast<uint64_t>(static_cast<int64_t>(y.raw) * y.raw);
+}
+
+Fixed FixedVec2::Length() const
+{
+	// The square root of a Q32.32 value is its length in Q16.16.
+	const uint64_t root = isqrt(LengthSquared());
+	return Fixed::FromRaw(root > INT32_MAX ? INT32_MAX : static_cast<int32_t>(root));
+}
+
+// --- Batch kernels -------------------------------------------------------
+
+void fixed_add(int32_t *__restrict out, const int32_t *__restrict a, const int32_t *__restrict b, size_t count)
+{
+	for (size_t i = 0; i < count; i++) out[i] = static_cast<int32_t>(static_cast<uint32_t>(a[i]) + static_cast<uint32_t>(b[i]));
+}
+
+void fixed_mul(int32_t *__restrict out, const int32_t *__restrict a, const int32_t *__restrict b, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		out[i] = static_cast<int32_t>((static_cast<int64_t>(a[i]) * b[i] + (Fixed::One >> 1)) >> Fixed::FractionBits);
+}
+
+void fixed_mul_add(int32_t *__restrict out, const int32_t *__restrict a, Fixed scale, size_t count)
+{
+	const int64_t factor = scale.raw;
+	for (size_t i = 0; i < count; i++) {
+		const int32_t product = static_cast<int32_t>((a[i] * factor + (Fixed::One >> 1)) >> Fixed::FractionBits);
+		out[i]				  = static_cast<int32_t>(static_cast<uint32_t>(out[i]) + static_cast<uint32_t>(product));
+	}
+}
+
+void fixed_clamp(int32_t *values, Fixed min, Fixed max, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		const int32_t value = values[i] < min.raw ? min.raw : values[i];
+		values[i]			= value > max.raw ? max.raw : value;
+	}
+}
+
+// --- Quantization --------------------------------------------------------
+
+static uint32_t quantize_raw(int32_t value, int32_t min, int32_t max, uint64_t range, uint64_t steps)
+{
+	const int32_t clamped = value < min ? min : (value > max ? max : value);
+	return static_cast<uint32_t>(((static_cast<uint64_t>(static_cast<int64_t>(clamped) - min)) * steps + range / 2) / range);
+}
+
+static int32_t dequantize_raw(uint32_t value, int32_t min, uint64_t range, uint64_t steps)
+{
+	const uint64_t clamped = value > steps ? steps : value;
+	return static_cast<int32_t>(min + static_cast<int64_t>((clamped * range + steps / 2) / steps));
+}
+
+static uint64_t quantize_range(Fixed min, Fixed max)
+{
+	const int64_t range = static_cast<int64_t>(max.raw) - min.raw;
+	return range > 0 ? static_cast<uint64_t>(range) : 1;
+}
+
+static uint64_t quantize_steps(int bits)
+{
+	return (uint64_t(1) << bits) - 1;
+}
+
+uint32_t quantize(Fixed value, Fixed min, Fixed max, int bits)
+{
+	return quantize_raw(value.raw, min.raw, max.raw, quantize_range(min, max), quantize_steps(bits));
+}
+
+Fixed dequantize(uint32_t value, Fixed min, Fixed max, int bits)
+{
+	return Fixed::FromRaw(dequantize_raw(value, min.raw, quantize_range(min, max), quantize_steps(bits)));
+}
+
+int quantize_bits(Fixed min, Fixed max, Fixed resolution)
+{
+	const uint64_t range = quantize_range(min, max);
+	const uint64_t step	 = resolution.raw > 0 ? resolution.raw : 1;
+
+	int bits = 1;
+	while (bits < 31 && quantize_steps(bits) * step < range) bits++;
+	return bits;
+}
+
+void quantize(uint32_t *out, const int32_t *values, Fixed min, Fixed max, int bits, size_t count)
+{
+	const uint64_t range = quantize_range(min, max);
+	const uint64_t steps = quantize_steps(bits);
+	for (size_t i = 0; i < count; i++) out[i] = quantize_raw(values[i], min.raw, max.raw, range, steps);
+}
+
+void dequantize(int32_t *out, const uint32_t *values, Fixed min, Fixed max, int bits, size_t count)
+{
+	const uint64_t range = quantize_range(min, max);
+	const uint64_t steps = quantize_steps(bits);
+	for (size_t i = 0; i < count; i++) out[i] = dequantize_raw(values[i], min.raw, range, steps);
+}
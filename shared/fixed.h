@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Q16.16 fixed point for simulation state shared by client and server.
+//
+// Only integer arithmetic with fixed rounding is used, so results are
+// bit-identical on every compiler, optimization level and CPU; floats enter
+// only through FromFloat() for setup and leave through ToFloat() for display.
+// The range is [-32768, 32768) with a resolution of 1/65536, overflow wraps.
+struct Fixed
+{
+	static const int	 FractionBits = 16;
+	static const int32_t One		  = 1 << FractionBits;
+
+	int32_t raw;
+
+	static constexpr Fixed FromRaw(int32_t raw) { return Fixed{raw}; }
+	static constexpr Fixed FromInt(int value) { return Fixed{static_cast<int32_t>(static_cast<uint32_t>(value) << FractionBits)}; }
+	static Fixed		   FromFloat(float value);	// rounds to nearest
+
+	float ToFloat() const { return static_cast<float>(raw) / One; }
+	int	  ToInt() const { return raw >> FractionBits; }	 // rounds down
+
+	Fixed operator+(Fixed other) const { return FromRaw(static_cast<int32_t>(static_cast<uint32_t>(raw) + static_cast<uint32_t>(other.raw))); }
+	Fixed operator-(Fixed other) const { return FromRaw(static_cast<int32_t>(static_cast<uint32_t>(raw) - static_cast<uint32_t>(other.raw))); }
+	Fixed operator-() const { return FromRaw(static_cast<int32_t>(0u - static_cast<uint32_t>(raw))); }
+	// Rounds to nearest, halves up.
+	Fixed operator*(Fixed other) const
+	{
+		return FromRaw(static_cast<int32_t>((static_cast<int64_t>(raw) * other.raw + (One >> 1)) >> FractionBits));
+	}
+	// Truncates toward zero, the divisor must not be zero.
+	Fixed operator/(Fixed other) const
+	{
+		return FromRaw(static_cast<int32_t>(static_cast<int64_t>(raw) * One / other.raw));
+	}
+
+	Fixed &operator+=(Fixed other) { return *this = *this + other; }
+	Fixed &operator-=(Fixed other) { return *this = *this - other; }
+	Fixed &operator*=(Fixed other) { return *this = *this * other; }
+	Fixed &operator/=(Fixed other) { return *this = *this / other; }
+
+	bool operator==(Fixed other) const { return raw == other.raw; }
+	bool operator!=(Fixed other) const { return raw != other.raw; }
+	bool operator<(Fixed other) const { return raw < other.raw; }
+	bool operator<=(Fixed other) const { return raw <= other.raw; }
+	bool operator>(Fixed other) const { return raw > other.raw; }
+	bool operator>=(Fixed other) const { return raw >= other.raw; }
+};
+
+Fixed fixed_abs(Fixed value);
+Fixed fixed_min(Fixed a, Fixed b);
+Fixed fixed_max(Fixed a, Fixed b);
+Fixed fixed_clamp(Fixed value, Fixed min, Fixed max);
+Fixed fixed_sqrt(Fixed value);	// rounds down, 0 for negative values
+
+struct FixedVec2
+{
+	Fixed x, y;
+
+	FixedVec2 operator+(FixedVec2 other) const { return {x + other.x, y + other.y}; }
+	FixedVec2 operator-(FixedVec2 other) const { return {x - other.x, y - other.y}; }
+	FixedVec2 operator*(Fixed scale) const { return {x * scale, y * scale}; }
+
+	FixedVec2 &operator+=(FixedVec2 other) { return *this = *this + other; }
+	FixedVec2 &operator-=(FixedVec2 other) { return *this = *this - other; }
+
+	bool operator==(FixedVec2 other) const { return x == other.x && y == other.y; }
+	bool operator!=(FixedVec2 other) const { return !(*this == other); }
+
+	// Raw products summed in Q32.32, exact over the whole range; a Q16.16
+	// sum would overflow past a length of about 181. Dot saturates at
+	// INT64_MAX, reached only by two (-32768, -32768) vectors.
+	int64_t	 Dot(FixedVec2 other) const;
+	uint64_t LengthSquared() const;
+	// Rounds down, saturates at the largest Fixed past a length of 32768.
+	Fixed Length() const;
+};
+
+// Batch kernels over structure-of-arrays columns of raw Q16.16 values.
+//
+// Plain loops over non-aliasing pointers with no branches, which compilers
+// turn into SIMD code for the target, and which give the same results as the
+// scalar operators above element for element.
+void fixed_add(int32_t *out, const int32_t *a, const int32_t *b, size_t count);
+void fixed_mul(int32_t *out, const int32_t *a, const int32_t *b, size_t count);
+// out[i] += a[i] * scale
+void fixed_mul_add(int32_t *out, const int32_t *a, Fixed scale, size_t count);
+void fixed_clamp(int32_t *values, Fixed min, Fixed max, size_t count);
+
+// Quantization onto `bits` bits (1 to 31) over [min, max], values outside are
+// clamped. Both ends map exactly and dequantize(quantize(x)) is a fixed point,
+// so simulating on quantized state keeps sender and receiver bit-identical.
+uint32_t quantize(Fixed value, Fixed min, Fixed max, int bits);
+Fixed	 dequantize(uint32_t value, Fixed min, Fixed max, int bits);
+// Fewest bits that resolve [min, max] in steps of at most `resolution`.
+int quantize_bits(Fixed min, Fixed max, Fixed resolution);
+
+void quantize(uint32_t *out, const int32_t *values, Fixed min, Fixed max, int bits, size_t count);
+void dequantize(int32_t *out, const uint32_t *values, Fixed min, Fixed max, int bits, size_t count);
+
+// Pairs with bit-packed serializers such as yojimbo's streams, through
+// SerializeBits() and the IsWriting/IsReading constants, e.g.
+//
+//     serialize_fixed(stream, position.x, Fixed::FromInt(-1024), Fixed::FromInt(1024), 20)
+template <typename Stream>
+bool serialize_fixed(Stream &stream, Fixed &value, Fixed min, Fixed max, int bits)
+{
+	uint32_t quantized = 0;
+	if (Stream::IsWriting) quantized = quantize(value, min, max, bits);
+	if (!stream.SerializeBits(quantized, bits)) return false;
+	if (Stream::IsReading) value = dequantize(quantized, min, max, bits);
+	return true;
+}
+
+template <typename Stream>
+bool serialize_fixed(Stream &stream, FixedVec2 &value, Fixed min, Fixed max, int bits)
+{
+	return serialize_fixed(stream, value.x, min, max, bits) && serialize_fixed(stream, value.y, min, max, bits);
+}
@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include <vector>
+
+#include "bench.h"
+#include "fixed.h"
+
+// Throughput of the fixed point batch kernels against the same work in float.
+//
+//     fixed_bench [bodies] [iterations]
+
+int main(int argc, char *argv[])
+{
+	const size_t bodies		= argc > 1 ? atoi(argv[1]) : 100000;
+	const int	 iterations = argc > 2 ? atoi(argv[2]) : 200;
+
+	const Fixed min = Fixed::FromInt(-1024), max = Fixed::FromInt(1024);
+	const Fixed dt	= Fixed::FromRaw(Fixed::One / 60);
+	const int	bits = quantize_bits(min, max, Fixed::FromRaw(Fixed::One / 64));
+
+	std::vector<float>	 float_x(bodies), float_y(bodies), float_vx(bodies), float_vy(bodies);
+	std::vector<int32_t> x(bodies), y(bodies), vx(bodies), vy(bodies);
+	std::vector<Fixed>	 scalar_x(bodies), scalar_y(bodies);
+
+	uint32_t seed = 1;
+	auto	 next = [&] { return Fixed::FromRaw(static_cast<int32_t>(seed = seed * 1664525u + 1013904223u) >> 12); };
+	for (size_t i = 0; i < bodies; i++) {
+		x[i] = scalar_x[i].raw = next().raw;
+		y[i] = scalar_y[i].raw = next().raw;
+		vx[i]				   = next().raw >> 4;
+		vy[i]				   = next().raw >> 4;
+
+		float_x[i]	= Fixed::FromRaw(x[i]).ToFloat();
+		float_y[i]	= Fixed::FromRaw(y[i]).ToFloat();
+		float_vx[i] = Fixed::FromRaw(vx[i]).ToFloat();
+		float_vy[i] = Fixed::FromRaw(vy[i]).ToFloat();
+	}
+
+	Bench bench("fixed_bench");
+
+	const float float_dt = dt.ToFloat();
+	bench.Run("integrate float", iterations, [&] {
+		for (size_t i = 0; i < bodies; i++) {
+			float_x[i] += float_vx[i] * float_dt;
+			float_y[i] += float_vy[i] * float_dt;
+		}
+	});
+	bench.Run("integrate fixed batch", iterations, [&] {
+		fixed_mul_add(x.data(), vx.data(), dt, bodies);
+		fixed_mul_add(y.data(), vy.data(), dt, bodies);
+	});
+	bench.Run("integrate fixed scalar", iterations, [&] {
+		for (size_t i = 0; i < bodies; i++) {
+			scalar_x[i] += Fixed::FromRaw(vx[i]) * dt;
+			scalar_y[i] += Fixed::FromRaw(vy[i]) * dt;
+		}
+	});
+
+	std::vector<uint32_t> quantized(bodies);
+	bench.Run("quantize", iterations, [&] { quantize(quantized.data(), x.data(), min, max, bits, bodies); });
+	bench.Run("dequantize", iterations, [&] { dequantize(x.data(), quantized.data(), min, max, bits, bodies); });
+
+	// The batch and scalar paths ran the same steps and must agree exactly.
+	size_t mismatches = 0;
+	for (size_t i = 0; i < bodies; i++) mismatches += scalar_y[i].raw != y[i];
+
+	bench.Counter("bodies", bodies);
+	bench.Counter("batch/scalar mismatches", mismatches);
+	bench.Counter("bits per coordinate", bits);
+	bench.Counter("bytes per position, float", 2 * sizeof(float));
+	bench.Counter("bytes per position, quantized", 2 * bits / 8.0);
+	bench.Print();
+
+	return mismatches ? 1 : 0;
+}
@@ -0,0 +1,170 @@
+#include "fixed.h"
+
+#include "check.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Bit-packed stream with the SerializeBits() interface of yojimbo's streams.
+template <bool Writing>
+struct BitStream
+{
+	enum { IsWriting = Writing };
+	enum { IsReading = !Writing };
+
+	std::vector<uint8_t> &bytes;
+	size_t				  bit = 0;
+
+	bool SerializeBits(uint32_t &value, int bits)
+	{
+		for (int i = 0; i < bits; i++, bit++) {
+			if (Writing) {
+				if (bit / 8 >= bytes.size()) bytes.push_back(0);
+				if (value >> i & 1) bytes[bit / 8] |= 1 << (bit % 8);
+			}
+			else {
+				if (bit / 8 >= bytes.size()) return false;
+				if (i == 0) value = 0;
+				value |= static_cast<uint32_t>(bytes[bit / 8] >> (bit % 8) & 1) << i;
+			}
+		}
+		return true;
+	}
+};
+
+static void test_arithmetic()
+{
+	const Fixed half  = Fixed::FromRaw(Fixed::One / 2);
+	const Fixed three = Fixed::FromInt(3);
+
+	CHECK((three * half).raw == Fixed::One * 3 / 2);
+	CHECK((three / half) == Fixed::FromInt(6));
+	CHECK((-three).ToInt() == -3);
+	CHECK(Fixed::FromFloat(-0.5f).ToInt() == -1);	// rounds down
+	CHECK(Fixed::FromFloat(1.25f).ToFloat() == 1.25f);
+	CHECK(fixed_sqrt(Fixed::FromInt(9)) == three);
+	CHECK(fixed_sqrt(Fixed::FromInt(2)).raw == 92681);	 // floor(sqrt(2) * 65536)
+	CHECK(fixed_sqrt(-three).raw == 0);
+	CHECK((FixedVec2{Fixed::FromInt(3), Fixed::FromInt(4)}.Length()) == Fixed::FromInt(5));
+
+	// Vector products are summed in Q32.32, well past a Q16.16 square.
+	const FixedVec2 far{Fixed::FromInt(200), Fixed::FromInt(0)};
+	CHECK(far.Length() == Fixed::FromInt(200));
+	CHECK(far.LengthSquared() == uint64_t(40000) << 32);
+	CHECK(far.Dot({Fixed::FromInt(-300), Fixed::FromInt(7)}) == -(int64_t(60000) << 32));
+	CHECK((FixedVec2{Fixed::FromInt(18000), Fixed::FromInt(-24000)}.Length()) == Fixed::FromInt(30000));
+	CHECK((FixedVec2{Fixed::FromFloat(0.5f), Fixed::FromInt(-20000)}.Length()).ToInt() == 20000);
+
+	// Near the edge of the range: exact squares, saturated results.
+	const FixedVec2 corner{Fixed::FromRaw(INT32_MIN), Fixed::FromRaw(INT32_MIN)};
+	CHECK(corner.LengthSquared() == uint64_t(1) << 63);
+	CHECK(corner.Dot(corner) == INT64_MAX);
+	CHECK(corner.Dot({Fixed::FromRaw(INT32_MAX), Fixed::FromRaw(INT32_MAX)}) == -2 * (int64_t(INT32_MAX) << 31));
+	CHECK(corner.Length().raw == INT32_MAX);
+	CHECK((FixedVec2{Fixed::FromRaw(INT32_MIN), Fixed::FromInt(0)}.Length()).raw == INT32_MAX);
+	CHECK((FixedVec2{Fixed::FromInt(23170), Fixed::FromInt(23170)}.Length()).ToInt() == 32767);
+
+	// Products round to nearest, halves up, also for negative values.
+	CHECK((Fixed::FromRaw(1) * half).raw == 1);
+	CHECK((Fixed::FromRaw(-1) * half).raw == 0);
+	CHECK((Fixed::FromRaw(3) * half).raw == 2);
+}
+
+// The batch kernels must match the scalar operators bit for bit.
+static void test_batch_matches_scalar()
+{
+	const size_t		 count = 1027;	// not a multiple of any vector width
+	std::vector<int32_t> a(count), b(count), sum(count), product(count), accumulated(count);
+
+	uint32_t seed = 12345;
+	auto	 next = [&] { return seed = seed * 1664525u + 1013904223u; };
+	for (size_t i = 0; i < count; i++) {
+		a[i]		   = static_cast<int32_t>(next()) >> 8;
+		b[i]		   = static_cast<int32_t>(next()) >> 12;
+		accumulated[i] = static_cast<int32_t>(next()) >> 4;
+	}
+	const std::vector<int32_t> base = accumulated;
+	const Fixed				   dt	= Fixed::FromRaw(Fixed::One / 60);
+
+	fixed_add(sum.data(), a.data(), b.data(), count);
+	fixed_mul(product.data(), a.data(), b.data(), count);
+	fixed_mul_add(accumulated.data(), a.data(), dt, count);
+
+	for (size_t i = 0; i < count; i++) {
+		const Fixed x = Fixed::FromRaw(a[i]), y = Fixed::FromRaw(b[i]);
+		CHECK(sum[i] == (x + y).raw);
+		CHECK(product[i] == (x * y).raw);
+		CHECK(accumulated[i] == (Fixed::FromRaw(base[i]) + x * dt).raw);
+	}
+
+	std::vector<int32_t> clamped = a;
+	fixed_clamp(clamped.data(), Fixed::FromInt(-1), Fixed::FromInt(1), count);
+	for (size_t i = 0; i < count; i++) CHECK(clamped[i] == fixed_clamp(Fixed::FromRaw(a[i]), Fixed::FromInt(-1), Fixed::FromInt(1)).raw);
+}
+
+static void test_quantize()
+{
+	const Fixed min = Fixed::FromInt(-1024), max = Fixed::FromInt(1024);
+
+	CHECK(quantize(min, min, max, 16) == 0);
+	CHECK(quantize(max, min, max, 16) == 0xffff);
+	CHECK(quantize(Fixed::FromInt(5000), min, max, 16) == 0xffff);
+	CHECK(dequantize(0, min, max, 16) == min);
+	CHECK(dequantize(0xffff, min, max, 16) == max);
+
+	// A 1/64 resolution over 2048 units is 131072 steps, 18 bits.
+	const int bits = quantize_bits(min, max, Fixed::FromRaw(Fixed::One / 64));
+	CHECK(bits == 18);
+
+	// Error within half a step, and quantized values are stable.
+	const int64_t step = (static_cast<int64_t>(max.raw) - min.raw) / ((1 << bits) - 1);
+	for (int32_t raw = min.raw; raw <= max.raw; raw += 7919) {
+		const Fixed value = Fixed::FromRaw(raw);
+		const Fixed once  = dequantize(quantize(value, min, max, bits), min, max, bits);
+		CHECK(std::abs(static_cast<int64_t>(once.raw) - raw) <= step / 2 + 1);
+		CHECK(dequantize(quantize(once, min, max, bits), min, max, bits) == once);
+	}
+
+	// Batch forms agree with the scalar ones.
+	std::vector<int32_t>  values = {min.raw, -12345678, 0, 1, 98765432, max.raw};
+	std::vector<uint32_t> quantized(values.size());
+	std::vector<int32_t>  restored(values.size());
+	quantize(quantized.data(), values.data(), min, max, bits, values.size());
+	dequantize(restored.data(), quantized.data(), min, max, bits, values.size());
+	for (size_t i = 0; i < values.size(); i++) {
+		CHECK(quantized[i] == quantize(Fixed::FromRaw(values[i]), min, max, bits));
+		CHECK(restored[i] == dequantize(quantized[i], min, max, bits).raw);
+	}
+}
+
+static void test_serialize()
+{
+	const Fixed min = Fixed::FromInt(-1024), max = Fixed::FromInt(1024);
+	FixedVec2	sent{Fixed::FromFloat(12.375f), Fixed::FromFloat(-700.5f)};
+
+	std::vector<uint8_t> bytes;
+	BitStream<true>		 writer{bytes};
+	CHECK(serialize_fixed(writer, sent, min, max, 20));
+	CHECK(bytes.size() == 5);	// 40 bits
+
+	FixedVec2		 received{};
+	BitStream<false> reader{bytes};
+	CHECK(serialize_fixed(reader, received, min, max, 20));
+	CHECK(received.x == dequantize(quantize(sent.x, min, max, 20), min, max, 20));
+	CHECK(received.y == dequantize(quantize(sent.y, min, max, 20), min, max, 20));
+
+	BitStream<false> short_reader{bytes};
+	short_reader.bit = 30;
+	CHECK(!serialize_fixed(short_reader, received, min, max, 20));
+}
+
+int main()
+{
+	test_arithmetic();
+	test_batch_matches_scalar();
+	test_quantize();
+	test_serialize();
+	printf("fixed_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,236 @@
+#include "memtrack.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Precedes every tracked block, keeping the block aligned for any type.
+struct alignas(alignof(std::max_align_t)) BlockHeader
+{
+	size_t size;
+	MemTag tag;
+};
+
+static const size_t HeaderSize = sizeof(BlockHeader);
+
+// One cache line per tag, subsystems allocating on different threads do not
+// contend.
+struct alignas(64) TagCounters
+{
+	std::atomic<int64_t>  live;
+	std::atomic<int64_t>  peak;
+	std::atomic<uint64_t> allocs;
+	std::atomic<uint64_t> frees;
+	std::atomic<uint64_t> allocated;
+};
+
+// Zero initialized before any constructor runs, operator new is usable from
+// the first allocation of the program.
+static TagCounters counters[static_cast<int>(MemTag::Count)];
+
+static thread_local MemTag scope_tag = MemTag::Other;
+
+static void count_alloc(MemTag tag, size_t size)
+{
+	auto		 &counter = counters[static_cast<int>(tag)];
+	const int64_t live	  = counter.live.fetch_add(size, std::memory_order_relaxed) + static_cast<int64_t>(size);
+	counter.allocs.fetch_add(1, std::memory_order_relaxed);
+	counter.allocated.fetch_add(size, std::memory_order_relaxed);
+
+	int64_t peak = counter.peak.load(std::memory_order_relaxed);
+	while (live > peak && !counter.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) continue;
+}
+
+static void count_free(MemTag tag, size_t size)
+{
+	auto &counter = counters[static_cast<int>(tag)];
+	counter.live.fetch_sub(size, std::memory_order_relaxed);
+	counter.frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+const char *mem_tag_name(MemTag tag)
+{
+	static const char *const names[] = {"other", "ui", "graphics", "files", "network", "game"};
+	return tag < MemTag::Count ? names[static_cast<int>(tag)] : "?";
+}
+
+void *mem_alloc(size_t size, MemTag tag)
+{
+	if (size > SIZE_MAX - HeaderSize) return nullptr;
+
+	auto *header = static_cast<BlockHeader *>(malloc(HeaderSize + size));
+	if (!header) return nullptr;
+
+	header->size = size;
+	header->tag	 = tag;
+	count_alloc(tag, size);
+	return reinterpret_cast<char *>(header) + HeaderSize;
+}
+
+void *mem_realloc(void *block, size_t size, MemTag tag)
+{
+	if (!block) return mem_alloc(size, tag);
+	if (size > SIZE_MAX - HeaderSize) return nullptr;
+
+	auto		*header	  = reinterpret_cast<BlockHeader *>(static_cast<char *>(block) - HeaderSize);
+	const size_t old_size = header->size;
+	const MemTag old_tag  = header->tag;
+
+	header = static_cast<BlockHeader *>(realloc(header, HeaderSize + size));
+	if (!header) return nullptr;
+
+	header->size = size;
+	count_free(old_tag, old_size);
+	count_alloc(old_tag, size);
+	return reinterpret_cast<char *>(header) + HeaderSize;
+}
+
+void mem_free(void *block)
+{
+	if (!block) return;
+
+	auto *header = reinterpret_cast<BlockHeader *>(static_cast<char *>(block) - HeaderSize);
+	count_free(header->tag, header->size);
+	free(header);
+}
+
+MemTagStats mem_stats(MemTag tag)
+{
+	const auto &counter = counters[static_cast<int>(tag)];
+	return {counter.live.load(std::memory_order_relaxed), counter.peak.load(std::memory_order_relaxed),
+			counter.allocs.load(std::memory_order_relaxed), counter.frees.load(std::memory_order_relaxed),
+			counter.allocated.load(std::memory_order_relaxed)};
+}
+
+MemScope::MemScope(MemTag tag) : previous{scope_tag}
+{
+	scope_tag = tag;
+}
+
+MemScope::~MemScope()
+{
+	scope_tag = previous;
+}
+
+// --- Memory Monitor ------------------------------------------------------
+
+MemoryMonitor::MemoryMonitor(double interval)
+	: interval{interval},
+	  next_sample{0.0},
+	  last_time{-1.0},
+	  budgets{},
+	  warned{},
+	  samples{}
+{
+}
+
+void MemoryMonitor::Collect(double time)
+{
+	const double elapsed = last_time < 0.0 ? 0.0 : time - last_time;
+	for (int tag = 0; tag < static_cast<int>(MemTag::Count); tag++) {
+		auto			 &sample   = samples[tag];
+		const MemTagStats current  = mem_stats(static_cast<MemTag>(tag));
+		sample.allocs_per_second   = elapsed > 0.0 ? (current.allocs - sample.stats.allocs) / elapsed : 0.0;
+		sample.bytes_per_second	   = elapsed > 0.0 ? (current.allocated - sample.stats.allocated) / elapsed : 0.0;
+		sample.stats			   = current;
+	}
+	last_time = time;
+}
+
+void MemoryMonitor::FormatLine(MemTag tag, char *line, size_t size) const
+{
+	const auto	&sample = samples[static_cast<int>(tag)];
+	const double mib	= 1024.0 * 1024.0;
+
+	int length = snprintf(line, size, "%-8s live %9.2f MiB  peak %9.2f MiB  %9.0f allocs/s %9.2f MiB/s  %llu blocks",
+						  mem_tag_name(tag), sample.stats.live / mib, sample.stats.peak / mib, sample.allocs_per_second,
+						  sample.bytes_per_second / mib,
+						  static_cast<unsigned long long>(sample.stats.allocs - sample.stats.frees));
+	if (budgets[static_cast<int>(tag)] && length > 0 && static_cast<size_t>(length) < size)
+		snprintf(line + length, size - length, "  budget %.2f MiB", budgets[static_cast<int>(tag)] / mib);
+}
+
+// --- Library hooks -------------------------------------------------------
+
+extern "C" {
+
+void *mem_graphics_malloc(size_t size)
+{
+	return mem_alloc(size, MemTag::Graphics);
+}
+
+void *mem_graphics_calloc(size_t count, size_t size)
+{
+	if (size && count > SIZE_MAX / size) return nullptr;
+
+	void *block = mem_alloc(count * size, MemTag::Graphics);
+	if (block) memset(block, 0, count * size);
+	return block;
+}
+
+void *mem_graphics_realloc(void *block, size_t size)
+{
+	return mem_realloc(block, size, MemTag::Graphics);
+}
+
+void mem_graphics_free(void *block)
+{
+	mem_free(block);
+}
+}
+
+// Replaceable global allocation functions, tagged by the current MemScope.
+// Over-aligned new keeps the standard library's implementation.
+
+void *operator new(size_t size)
+{
+	if (void *block = mem_alloc(size, scope_tag)) return block;
+	throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+	return mem_alloc(size, scope_tag);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+	return mem_alloc(size, scope_tag);
+}
+
+void operator delete(void *block) noexcept
+{
+	mem_free(block);
+}
+
+void operator delete[](void *block) noexcept
+{
+	mem_free(block);
+}
+
+void operator delete(void *block, size_t) noexcept
+{
+	mem_free(block);
+}
+
+void operator delete[](void *block, size_t) noexcept
+{
+	mem_free(block);
+}
+
+void operator delete(void *block, const std::nothrow_t &) noexcept
+{
+	mem_free(block);
+}
+
+void operator delete[](void *block, const std::nothrow_t &) noexcept
+{
+	mem_free(block);
+}
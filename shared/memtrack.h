@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Tagged allocation accounting.
+//
+// Allocations made through mem_alloc() carry a small header with their size
+// and subsystem tag, so live and peak bytes and allocation counts are kept
+// per subsystem with a few relaxed atomic updates. Libraries are routed here
+// through their own hooks: PhysFS with PHYSFS_setAllocator(), raylib with the
+// RL_MALLOC family (see build.zig), yojimbo with an Allocator subclass.
+// Everything else allocating with operator new, RmlUi included, is tagged by
+// the innermost MemScope on the allocating thread, Other outside of any.
+//
+// Blocks must be freed by the matching hook: mem_free() only takes memory
+// from mem_alloc(), mem_realloc() or operator new.
+
+enum class MemTag : uint8_t {
+	Other,
+	UI,		   // RmlUi, through MemScope
+	Graphics,  // raylib
+	Files,	   // PhysFS
+	Network,   // yojimbo
+	Game,
+	Count,
+};
+
+const char *mem_tag_name(MemTag tag);
+
+void *mem_alloc(size_t size, MemTag tag);
+void *mem_realloc(void *block, size_t size, MemTag tag);  // keeps the tag of an existing block
+void  mem_free(void *block);
+
+struct MemTagStats
+{
+	int64_t	 live;		 // bytes
+	int64_t	 peak;		 // bytes
+	uint64_t allocs;	 // since start
+	uint64_t frees;
+	uint64_t allocated;	 // bytes, since start
+};
+
+MemTagStats mem_stats(MemTag tag);
+
+// Tags operator new allocations on this thread until destroyed.
+class MemScope
+{
+	MemTag previous;
+
+   public:
+	explicit MemScope(MemTag tag);
+	~MemScope();
+
+	MemScope(const MemScope &)			  = delete;
+	MemScope &operator=(const MemScope &) = delete;
+};
+
+// Periodic allocation rates and soft budgets.
+//
+// Update() samples the counters every `interval` seconds; a subsystem going
+// over its budget is reported once through warn(tag, stats, budget), and
+// again only after dropping back under it.
+class MemoryMonitor
+{
+   public:
+	struct Sample
+	{
+		MemTagStats stats;
+		double		allocs_per_second;
+		double		bytes_per_second;
+	};
+
+	explicit MemoryMonitor(double interval = 1.0);
+
+	// Bytes, 0 for no budget.
+	void	SetBudget(MemTag tag, int64_t bytes) { budgets[static_cast<int>(tag)] = bytes; }
+	int64_t GetBudget(MemTag tag) const { return budgets[static_cast<int>(tag)]; }
+
+	template <typename Warn>
+	void Update(double time, Warn &&warn)
+	{
+		if (time < next_sample) return;
+		Collect(time);
+		next_sample = time + interval;
+
+		for (int tag = 0; tag < static_cast<int>(MemTag::Count); tag++) {
+			const bool over = budgets[tag] && samples[tag].stats.live > budgets[tag];
+			if (over && !warned[tag]) warn(static_cast<MemTag>(tag), samples[tag].stats, budgets[tag]);
+			warned[tag] = over;
+		}
+	}
+
+	const Sample &Get(MemTag tag) const { return samples[static_cast<int>(tag)]; }
+
+	// Calls print(line) with a line per subsystem, as of the last sample.
+	template <typename Print>
+	void Report(Print &&print) const
+	{
+		char line[160];
+		for (int tag = 0; tag < static_cast<int>(MemTag::Count); tag++) {
+			FormatLine(static_cast<MemTag>(tag), line, sizeof(line));
+			print(static_cast<const char *>(line));
+		}
+	}
+
+   private:
+	double	interval;
+	double	next_sample;
+	double	last_time;
+	int64_t budgets[static_cast<int>(MemTag::Count)];
+	bool	warned[static_cast<int>(MemTag::Count)];
+	Sample	samples[static_cast<int>(MemTag::Count)];
+
+	void Collect(double time);
+	void FormatLine(MemTag tag, char *line, size_t size) const;
+};
+
+// C linkage for raylib's RL_MALLOC family.
+extern "C" {
+void *mem_graphics_malloc(size_t size);
+void *mem_graphics_calloc(size_t count, size_t size);
+void *mem_graphics_realloc(void *block, size_t size);
+void  mem_graphics_free(void *block);
+}
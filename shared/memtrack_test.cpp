@@ -0,0 +1,123 @@
+#include "memtrack.h"
+
+#include "check.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static void test_counters()
+{
+	const MemTagStats before = mem_stats(MemTag::Game);
+
+	void *a = mem_alloc(100, MemTag::Game);
+	void *b = mem_alloc(300, MemTag::Game);
+	CHECK(a && b);
+	CHECK(reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t) == 0);
+
+	MemTagStats stats = mem_stats(MemTag::Game);
+	CHECK(stats.live - before.live == 400);
+	CHECK(stats.allocs - before.allocs == 2);
+	CHECK(stats.peak >= before.live + 400);
+
+	memset(a, 0xab, 100);
+	a	  = mem_realloc(a, 1000, MemTag::Other);  // keeps its tag
+	stats = mem_stats(MemTag::Game);
+	CHECK(stats.live - before.live == 1300);
+	CHECK(static_cast<unsigned char *>(a)[99] == 0xab);
+
+	mem_free(a);
+	mem_free(b);
+	mem_free(nullptr);
+	stats = mem_stats(MemTag::Game);
+	CHECK(stats.live == before.live);
+	CHECK(stats.peak >= before.live + 1300);
+	CHECK(stats.allocs - stats.frees == before.allocs - before.frees);
+
+	auto *zeroed = static_cast<unsigned char *>(mem_graphics_calloc(16, 4));
+	for (int i = 0; i < 64; i++) CHECK(zeroed[i] == 0);
+	CHECK(mem_stats(MemTag::Graphics).live >= 64);
+	mem_graphics_free(zeroed);
+	CHECK(!mem_graphics_calloc(SIZE_MAX / 2, 4));
+}
+
+static void test_scope()
+{
+	const int64_t ui_before	   = mem_stats(MemTag::UI).live;
+	const int64_t other_before = mem_stats(MemTag::Other).live;
+
+	std::vector<int> *outside = new std::vector<int>(1000);
+	{
+		MemScope		 ui(MemTag::UI);
+		std::vector<int> inside(1000);
+		CHECK(mem_stats(MemTag::UI).live - ui_before >= 4000);
+		{
+			MemScope	game(MemTag::Game);
+			std::string text(500, 'x');
+			CHECK(mem_stats(MemTag::UI).live - ui_before < 4500);
+		}
+	}
+	CHECK(mem_stats(MemTag::UI).live == ui_before);
+	CHECK(mem_stats(MemTag::Other).live - other_before >= 4000);
+
+	// Freed outside the scope, still accounted to where it came from.
+	std::vector<int> *later;
+	{
+		MemScope ui(MemTag::UI);
+		later = new std::vector<int>(10);
+	}
+	delete later;
+	delete outside;
+	CHECK(mem_stats(MemTag::UI).live == ui_before);
+	CHECK(mem_stats(MemTag::Other).live == other_before);
+}
+
+static void test_monitor()
+{
+	MemoryMonitor monitor(1.0);
+	monitor.SetBudget(MemTag::Network, 1000);
+
+	int	 warnings = 0;
+	auto warn	  = [&](MemTag tag, const MemTagStats &stats, int64_t budget) {
+		CHECK(tag == MemTag::Network);
+		CHECK(stats.live > budget);
+		warnings++;
+	};
+
+	monitor.Update(0.0, warn);
+	void *block = mem_alloc(2000, MemTag::Network);
+	monitor.Update(0.5, warn);	// between samples
+	CHECK(warnings == 0);
+	monitor.Update(1.0, warn);
+	CHECK(warnings == 1);
+	CHECK(monitor.Get(MemTag::Network).allocs_per_second == 1.0);
+	CHECK(monitor.Get(MemTag::Network).bytes_per_second == 2000.0);
+
+	monitor.Update(2.0, warn);	// still over, reported once
+	CHECK(warnings == 1);
+
+	mem_free(block);
+	monitor.Update(3.0, warn);
+	block = mem_alloc(2000, MemTag::Network);
+	monitor.Update(4.0, warn);
+	CHECK(warnings == 2);
+	mem_free(block);
+
+	int lines = 0;
+	monitor.Report([&](const char *line) {
+		CHECK(strlen(line) > 0);
+		if (!strncmp(line, "network", 7)) CHECK(strstr(line, "budget"));
+		lines++;
+	});
+	CHECK(lines == static_cast<int>(MemTag::Count));
+}
+
+int main()
+{
+	test_counters();
+	test_scope();
+	test_monitor();
+	printf("memtrack_test: ok\n");
+	return 0;
+}
@@ -0,0 +1,184 @@
+#include "net_relay.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+// Larger than any netcode.io packet.
+static const int MaxDatagram = 2048;
+
+static int open_socket(uint32_t host, uint16_t port)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	if (fd < 0) return -1;
+
+	sockaddr_in address{};
+	address.sin_family		= AF_INET;
+	address.sin_addr.s_addr = host;
+	address.sin_port		= htons(port);
+
+	const int buffer_size = 1 << 20;
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buffer_size, sizeof(buffer_size));
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buffer_size, sizeof(buffer_size));
+
+	if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK) < 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static void send_to(int fd, const uint8_t *data, int bytes, uint32_t host, uint16_t port)
+{
+	sockaddr_in address{};
+	address.sin_family		= AF_INET;
+	address.sin_addr.s_addr = host;
+	address.sin_port		= port;
+	sendto(fd, data, bytes, 0, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+}
+
+NetRelay::NetRelay(const Config &config)
+	: config{config},
+	  upstream{config.upstream},
+	  downstream{config.downstream},
+	  listen_socket{-1},
+	  port{0},
+	  target_host{0},
+	  target_port{0}
+{
+}
+
+NetRelay::~NetRelay()
+{
+	Close();
+}
+
+bool NetRelay::Open(uint16_t listen_port, const char *host, uint16_t target)
+{
+	Close();
+
+	in_addr target_address;
+	if (inet_pton(AF_INET, host, &target_address) != 1) return false;
+	target_host = target_address.s_addr;
+	target_port = htons(target);
+
+	listen_socket = open_socket(htonl(INADDR_LOOPBACK), listen_port);
+	if (listen_socket < 0) return false;
+
+	sockaddr_in bound{};
+	socklen_t	length = sizeof(bound);
+	getsockname(listen_socket, reinterpret_cast<sockaddr *>(&bound), &length);
+	port = ntohs(bound.sin_port);
+
+	sessions.assign(config.max_sessions, Session{0, 0, -1, 0, 0.0});
+	return true;
+}
+
+void NetRelay::Close()
+{
+	for (auto &session : sessions) CloseSession(session);
+	sessions.clear();
+	if (listen_socket >= 0) close(listen_socket);
+	listen_socket = -1;
+	port		  = 0;
+}
+
+void NetRelay::CloseSession(Session &session)
+{
+	if (session.socket >= 0) close(session.socket);
+	session.socket = -1;
+}
+
+void NetRelay::SetConditions(const NetSimConfig &up, const NetSimConfig &down)
+{
+	upstream.SetConfig(up);
+	downstream.SetConfig(down);
+}
+
+int NetRelay::GetSessionCount() const
+{
+	int count = 0;
+	for (const auto &session : sessions) count += session.socket >= 0;
+	return count;
+}
+
+// The client's session, a new one when there is a free slot, -1 otherwise.
+int NetRelay::FindSession(uint32_t host, uint16_t client_port, double time)
+{
+	int free_slot = -1;
+	for (int i = 0; i < static_cast<int>(sessions.size()); i++) {
+		auto &session = sessions[i];
+		if (session.socket < 0) {
+			if (free_slot < 0) free_slot = i;
+		} else if (session.host == host && session.port == client_port) {
+			session.last_seen = time;
+			return i;
+		}
+	}
+	if (free_slot < 0) return -1;
+
+	// Any port on any interface: a loopback bound socket could not reach a
+	// target on another host. The target answers wherever it came from.
+	const int fd = open_socket(htonl(INADDR_ANY), 0);
+	if (fd < 0) return -1;
+
+	auto &session	  = sessions[free_slot];
+	session.host	  = host;
+	session.port	  = client_port;
+	session.socket	  = fd;
+	session.last_seen = time;
+	session.generation++;
+	return free_slot;
+}
+
+NetRelay::Session *NetRelay::FindTag(uint32_t tag)
+{
+	auto &session = sessions[tag & 0xffff];
+	return session.socket >= 0 && session.generation == tag >> 16 ? &session : nullptr;
+}
+
+void NetRelay::Update(double time)
+{
+	if (listen_socket < 0) return;
+
+	uint8_t		buffer[MaxDatagram];
+	sockaddr_in from;
+	socklen_t	length;
+
+	for (;;) {
+		length			 = sizeof(from);
+		const auto bytes = recvfrom(listen_socket, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&from), &length);
+		if (bytes <= 0) break;
+
+		const int session = FindSession(from.sin_addr.s_addr, from.sin_port, time);
+		if (session >= 0) upstream.Send(time, buffer, static_cast<int>(bytes), GetTag(session));
+	}
+
+	for (int i = 0; i < static_cast<int>(sessions.size()); i++) {
+		auto &session = sessions[i];
+		if (session.socket < 0) continue;
+
+		for (;;) {
+			length			 = sizeof(from);
+			const auto bytes = recvfrom(session.socket, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&from), &length);
+			if (bytes <= 0) break;
+			if (from.sin_addr.s_addr == target_host && from.sin_port == target_port)
+				downstream.Send(time, buffer, static_cast<int>(bytes), GetTag(i));
+		}
+
+		if (time - session.last_seen > config.session_timeout) CloseSession(session);
+	}
+
+	// Sessions closed meanwhile drop what is still in flight for them.
+	upstream.Receive(time, [this](const uint8_t *data, int bytes, uint32_t tag) {
+		if (Session *session = FindTag(tag)) send_to(session->socket, data, bytes, target_host, target_port);
+	});
+	downstream.Receive(time, [this](const uint8_t *data, int bytes, uint32_t tag) {
+		if (Session *session = FindTag(tag)) send_to(listen_socket, data, bytes, session->host, session->port);
+	});
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "net_sim.h"
+
+// In-process UDP relay applying simulated network conditions between
+// endpoints that do not know about it.
+//
+// Datagrams arriving on the relay's port pass through the upstream
+// simulator and go on to the target from a socket per client session, so the
+// target still sees every client at its own address. Replies come back
+// through the downstream simulator. Nothing runs in the background: the
+// owner calls Update() from its loop with its own clock, which keeps the
+// simulation as reproducible as that clock.
+//
+// yojimbo's insecure connect tokens carry the addresses a server accepts: a
+// client connecting through the relay lists the relay first and the server
+// after it, the server finds its own address in the token and answers
+// through the relay.
+//
+// IPv4 and POSIX sockets, it is a test tool.
+class NetRelay
+{
+   public:
+	struct Config
+	{
+		NetSimConfig upstream;	   // towards the target
+		NetSimConfig downstream;   // back to the clients
+		int			 max_sessions	 = 64;
+		double		 session_timeout = 30.0;  // seconds without a datagram from the client
+
+		// The same conditions both ways, drawn independently.
+		static Config Symmetric(const NetSimConfig &conditions)
+		{
+			Config config;
+			config.upstream			= conditions;
+			config.downstream		= conditions;
+			config.downstream.seed	= conditions.seed ^ 0x5bd1e995;
+			return config;
+		}
+	};
+
+	explicit NetRelay(const Config &config);
+	~NetRelay();
+
+	NetRelay(const NetRelay &)			  = delete;
+	NetRelay &operator=(const NetRelay &) = delete;
+
+	// Listens on 127.0.0.1:listen_port, 0 for any free port, and relays to
+	// target_host:target_port, a numeric IPv4 address.
+	bool Open(uint16_t listen_port, const char *target_host, uint16_t target_port);
+	void Close();
+
+	// Forwards what arrived, releases what is due at `time`, in seconds.
+	void Update(double time);
+
+	// Queued datagrams keep their delivery times.
+	void SetConditions(const NetSimConfig &upstream, const NetSimConfig &downstream);
+
+	uint16_t		   GetPort() const { return port; }
+	int				   GetSessionCount() const;
+	const NetSimStats &GetUpstreamStats() const { return upstream.GetStats(); }
+	const NetSimStats &GetDownstreamStats() const { return downstream.GetStats(); }
+
+   private:
+	struct Session
+	{
+		uint32_t host;	// client address, network order
+		uint16_t port;
+		int		 socket;	  // towards the target, -1 when the session is free
+		uint16_t generation;  // of the slot, datagrams in flight for an earlier session are dropped
+		double	 last_seen;
+	};
+
+	Config				 config;
+	NetSimulator		 upstream;
+	NetSimulator		 downstream;
+	int					 listen_socket;
+	uint16_t			 port;
+	uint32_t			 target_host;  // network order
+	uint16_t			 target_port;
+	std::vector<Session> sessions;
+
+	int		 FindSession(uint32_t host, uint16_t port, double time);
+	void	 CloseSession(Session &session);
+	uint32_t GetTag(int index) const { return static_cast<uint32_t>(sessions[index].generation) << 16 | index; }
+	Session *FindTag(uint32_t tag);
+};
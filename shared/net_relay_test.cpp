@@ -0,0 +1,157 @@
+#include "net_relay.h"
+
+#include "check.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// A bound, non-blocking loopback socket and its port.
+static int open_loopback(uint16_t &port)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	CHECK(fd >= 0);
+
+	sockaddr_in address{};
+	address.sin_family		= AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	CHECK(bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0);
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+	socklen_t length = sizeof(address);
+	getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length);
+	port = ntohs(address.sin_port);
+	return fd;
+}
+
+static void send_to(int fd, uint16_t port, const char *text)
+{
+	sockaddr_in address{};
+	address.sin_family		= AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port		= htons(port);
+	CHECK(sendto(fd, text, strlen(text), 0, reinterpret_cast<sockaddr *>(&address), sizeof(address)) > 0);
+}
+
+// Next datagram, empty when there is none. `from` gets the sender's port.
+static std::string receive(int fd, uint16_t *from = nullptr)
+{
+	char		buffer[256];
+	sockaddr_in address{};
+	socklen_t	length = sizeof(address);
+	auto		bytes  = recvfrom(fd, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr *>(&address), &length);
+	if (bytes <= 0) return {};
+	if (from) *from = ntohs(address.sin_port);
+	return std::string(buffer, bytes);
+}
+
+// Relay updates at simulated times, with a short real pause for the
+// loopback datagrams to land.
+static void pump(NetRelay &relay, double time)
+{
+	usleep(2000);
+	relay.Update(time);
+}
+
+static void test_relay()
+{
+	uint16_t server_port, first_port, second_port;
+	int		 server = open_loopback(server_port);
+	int		 first	= open_loopback(first_port);
+	int		 second = open_loopback(second_port);
+
+	NetRelay::Config config;
+	config.upstream.latency_ms	 = 50.0;
+	config.downstream.latency_ms = 50.0;
+	config.session_timeout		 = 10.0;
+	NetRelay relay(config);
+	CHECK(relay.Open(0, "127.0.0.1", server_port));
+	CHECK(relay.GetPort() != 0);
+
+	send_to(first, relay.GetPort(), "one");
+	send_to(second, relay.GetPort(), "two");
+	pump(relay, 0.0);
+	CHECK(relay.GetSessionCount() == 2);
+
+	// Held for the latency.
+	pump(relay, 0.049);
+	CHECK(receive(server).empty());
+	pump(relay, 0.050);
+
+	// Each client arrives from its own session port.
+	uint16_t	from_first = 0, from_second = 0;
+	std::string a = receive(server, &from_first), b = receive(server, &from_second);
+	if (a == "two") {
+		std::swap(a, b);
+		std::swap(from_first, from_second);
+	}
+	CHECK(a == "one" && b == "two");
+	CHECK(from_first != from_second && from_first != first_port);
+
+	// Replies go back to the right client, after the latency again.
+	send_to(server, from_second, "reply");
+	pump(relay, 0.060);
+	CHECK(receive(second).empty());
+	pump(relay, 0.110);
+	uint16_t reply_from = 0;
+	CHECK(receive(second, &reply_from) == "reply");
+	CHECK(reply_from == relay.GetPort());
+	CHECK(receive(first).empty());
+
+	CHECK(relay.GetUpstreamStats().delivered == 2);
+	CHECK(relay.GetDownstreamStats().delivered == 1);
+
+	// Idle sessions expire, a reply in flight for one is dropped.
+	send_to(server, from_first, "late");
+	pump(relay, 20.0);
+	CHECK(relay.GetSessionCount() == 0);
+	pump(relay, 21.0);
+	CHECK(receive(first).empty());
+
+	relay.Close();
+	close(server);
+	close(first);
+	close(second);
+}
+
+static void test_loss()
+{
+	uint16_t server_port, client_port;
+	int		 server = open_loopback(server_port);
+	int		 client = open_loopback(client_port);
+
+	NetRelay::Config config;
+	config.upstream.loss = 1.0;
+	NetRelay relay(config);
+	CHECK(relay.Open(0, "127.0.0.1", server_port));
+
+	send_to(client, relay.GetPort(), "lost");
+	pump(relay, 0.0);
+	pump(relay, 1.0);
+	CHECK(receive(server).empty());
+	CHECK(relay.GetUpstreamStats().lost == 1);
+
+	// Conditions change at runtime.
+	relay.SetConditions(NetSimConfig{}, NetSimConfig{});
+	send_to(client, relay.GetPort(), "through");
+	pump(relay, 2.0);
+	pump(relay, 2.0);
+	CHECK(receive(server) == "through");
+
+	close(server);
+	close(client);
+}
+
+int main()
+{
+	test_relay();
+	test_loss();
+	printf("net_relay_test: ok\n");
+	return 0;
+}
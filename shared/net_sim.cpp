@@ -0,0 +1,157 @@
+#include "net_sim.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+bool net_sim_parse_arg(NetSimConfig &config, int argc, char *argv[], int &i)
+{
+	if (strncmp(argv[i], "--net-", 6) || i + 1 >= argc) return false;
+
+	const char *option = argv[i] + 6;
+	const char *value  = argv[i + 1];
+	if (!strcmp(option, "latency"))
+		config.latency_ms = atof(value);
+	else if (!strcmp(option, "jitter"))
+		config.jitter_ms = atof(value);
+	else if (!strcmp(option, "distribution")) {
+		if (!strcmp(value, "constant"))
+			config.distribution = NetSimConfig::Distribution::Constant;
+		else if (!strcmp(value, "uniform"))
+			config.distribution = NetSimConfig::Distribution::Uniform;
+		else if (!strcmp(value, "normal"))
+			config.distribution = NetSimConfig::Distribution::Normal;
+		else if (!strcmp(value, "pareto"))
+			config.distribution = NetSimConfig::Distribution::Pareto;
+		else
+			return false;
+	} else if (!strcmp(option, "loss"))
+		config.loss = atof(value) / 100.0;
+	else if (!strcmp(option, "burst"))
+		config.burst_rate = atof(value) / 100.0;
+	else if (!strcmp(option, "burst-length"))
+		config.burst_length = atof(value);
+	else if (!strcmp(option, "reorder"))
+		config.reorder = atof(value) / 100.0;
+	else if (!strcmp(option, "duplicate"))
+		config.duplicate = atof(value) / 100.0;
+	else if (!strcmp(option, "bandwidth"))
+		config.bandwidth_kbps = atof(value);
+	else if (!strcmp(option, "queue"))
+		config.queue_bytes = atoi(value);
+	else if (!strcmp(option, "seed"))
+		config.seed = strtoull(value, nullptr, 10);
+	else
+		return false;
+
+	i++;
+	return true;
+}
+
+NetSimulator::NetSimulator(const NetSimConfig &config)
+	: config{config},
+	  state{config.seed},
+	  order{0},
+	  in_burst{false},
+	  link_free{0.0},
+	  last_in_order{0.0},
+	  stats{}
+{
+}
+
+void NetSimulator::SetConfig(const NetSimConfig &new_config)
+{
+	if (new_config.seed != config.seed) state = new_config.seed;
+	config = new_config;
+}
+
+// splitmix64, the same sequence everywhere.
+double NetSimulator::Random()
+{
+	uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+	z		   = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z		   = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	z ^= z >> 31;
+	return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+double NetSimulator::Delay(double u, double v) const
+{
+	const double pi		= 3.14159265358979323846;
+	double		 delay	= config.latency_ms;
+	const double jitter = config.jitter_ms;
+	switch (config.distribution) {
+		case NetSimConfig::Distribution::Constant: delay += jitter * u; break;
+		case NetSimConfig::Distribution::Uniform: delay += jitter * (2.0 * u - 1.0); break;
+		case NetSimConfig::Distribution::Normal: delay += jitter * sqrt(-2.0 * log(1.0 - u)) * cos(2.0 * pi * v); break;
+		case NetSimConfig::Distribution::Pareto: delay += jitter * (pow(1.0 - u, -1.0 / 3.0) - 1.0); break;	// shape 3
+	}
+	return std::max(delay, 0.0) / 1000.0;
+}
+
+void NetSimulator::Queue(double time, const uint8_t *data, int bytes, uint32_t tag)
+{
+	Packet packet;
+	packet.time	 = time;
+	packet.order = order++;
+	packet.tag	 = tag;
+	packet.data.assign(data, data + bytes);
+	queue.push_back(std::move(packet));
+	std::push_heap(queue.begin(), queue.end(), Later());
+}
+
+void NetSimulator::Send(double time, const uint8_t *data, int bytes, uint32_t tag)
+{
+	stats.sent++;
+
+	// Every packet takes the same draws, whatever happens to it, so one
+	// setting does not shift the fate of the packets after it.
+	const double loss_draw		= Random();
+	const double burst_draw		= Random();
+	const double burst_end_draw = Random();
+	const double duplicate_draw = Random();
+	const double reorder_draw	= Random();
+	const double delay_u = Random(), delay_v = Random();
+	const double copy_u = Random(), copy_v = Random();
+
+	// Gilbert model: a burst ends after each of its packets with probability
+	// 1 / burst_length, which makes that the mean length.
+	if (in_burst || burst_draw < config.burst_rate) {
+		const double burst_end = config.burst_length > 1.0 ? 1.0 / config.burst_length : 1.0;
+		in_burst			   = burst_end_draw >= burst_end;
+		stats.burst_lost++;
+		return;
+	}
+	if (loss_draw < config.loss) {
+		stats.lost++;
+		return;
+	}
+
+	double departure = time;
+	if (config.bandwidth_kbps > 0) {
+		const double bytes_per_second = config.bandwidth_kbps * 1000.0 / 8.0;
+		const double backlog		  = std::max(link_free - time, 0.0) * bytes_per_second;
+		if (backlog + bytes > config.queue_bytes) {
+			stats.queue_drops++;
+			return;
+		}
+		departure = std::max(time, link_free) + bytes / bytes_per_second;
+		link_free = departure;
+	}
+
+	double delivery = departure + Delay(delay_u, delay_v);
+	if (reorder_draw < config.reorder) {
+		const double hold_ms = config.reorder_ms > 0 ? config.reorder_ms : config.jitter_ms + 10.0;
+		delivery += hold_ms / 1000.0;
+		stats.reordered++;
+	} else {
+		delivery	  = std::max(delivery, last_in_order);
+		last_in_order = delivery;
+	}
+	Queue(delivery, data, bytes, tag);
+
+	if (duplicate_draw < config.duplicate) {
+		Queue(departure + Delay(copy_u, copy_v), data, bytes, tag);
+		stats.duplicated++;
+	}
+}
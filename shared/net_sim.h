@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Network conditions, for one direction of a link.
+struct NetSimConfig
+{
+	enum class Distribution : uint8_t {
+		Constant,  // latency_ms exactly, plus jitter uniform in [0, jitter_ms)
+		Uniform,   // latency_ms +- jitter_ms
+		Normal,	   // mean latency_ms, deviation jitter_ms
+		Pareto,	   // at least latency_ms, heavy tail of scale jitter_ms
+	};
+
+	double		 latency_ms	  = 0.0;  // one way
+	double		 jitter_ms	  = 0.0;
+	Distribution distribution = Distribution::Constant;
+
+	double loss			= 0.0;	// probability, independent per packet
+	double burst_rate	= 0.0;	// probability a packet starts a loss burst
+	double burst_length = 4.0;	// mean packets lost in a burst
+
+	double reorder	  = 0.0;  // probability a packet is held back
+	double reorder_ms = 0.0;  // extra delay of held back packets, jitter_ms + 10 when 0
+
+	double duplicate = 0.0;	 // probability a packet is delivered twice
+
+	double bandwidth_kbps = 0.0;		 // link rate, 0 for unlimited
+	int	   queue_bytes	  = 64 << 10;	 // queued for the link beyond this are dropped
+
+	uint64_t seed = 1;
+
+	bool IsActive() const
+	{
+		return latency_ms > 0 || jitter_ms > 0 || loss > 0 || burst_rate > 0 || reorder > 0 || duplicate > 0 ||
+			   bandwidth_kbps > 0;
+	}
+};
+
+// Parses a `--net-...` option at argv[i] into `config`, advancing i past its
+// value. False when argv[i] is not one, so callers chain their own options.
+//
+//     --net-latency MS  --net-jitter MS  --net-distribution constant|uniform|normal|pareto
+//     --net-loss PCT  --net-burst PCT  --net-burst-length PACKETS  --net-reorder PCT
+//     --net-duplicate PCT  --net-bandwidth KBPS  --net-queue BYTES  --net-seed N
+bool net_sim_parse_arg(NetSimConfig &config, int argc, char *argv[], int &i);
+
+struct NetSimStats
+{
+	uint64_t sent;	// packets handed to Send()
+	uint64_t delivered;
+	uint64_t lost;		   // independent loss
+	uint64_t burst_lost;   // lost in bursts
+	uint64_t queue_drops;  // over the bandwidth queue
+	uint64_t duplicated;
+	uint64_t reordered;
+	uint64_t bytes_delivered;
+};
+
+// Deterministic packet delay line.
+//
+// Decisions are drawn from a generator seeded by config.seed, one fixed
+// sequence of draws per packet, so the same packets sent at the same times
+// meet the same fate on every run and every platform. Packets not held back
+// for reordering are delivered in send order however jitter falls; the
+// bandwidth cap serializes packets onto the link before latency applies.
+class NetSimulator
+{
+   public:
+	explicit NetSimulator(const NetSimConfig &config);
+
+	// Takes effect for packets sent from now on, queued ones keep their times.
+	void				SetConfig(const NetSimConfig &config);
+	const NetSimConfig &GetConfig() const { return config; }
+
+	// Queues a packet sent at `time` in seconds, unless it is lost. `tag` is
+	// handed back on delivery, for routing.
+	void Send(double time, const uint8_t *data, int bytes, uint32_t tag = 0);
+
+	// Calls deliver(data, bytes, tag) for every packet due at `time`, in
+	// delivery order. Returns the number delivered.
+	template <typename Deliver>
+	int Receive(double time, Deliver &&deliver)
+	{
+		int count = 0;
+		while (!queue.empty() && queue.front().time <= time) {
+			std::pop_heap(queue.begin(), queue.end(), Later());
+			Packet packet = std::move(queue.back());
+			queue.pop_back();
+
+			stats.delivered++;
+			stats.bytes_delivered += packet.data.size();
+			deliver(packet.data.data(), static_cast<int>(packet.data.size()), packet.tag);
+			count++;
+		}
+		return count;
+	}
+
+	// Time of the next delivery, a negative value when nothing is queued.
+	double GetNextDelivery() const { return queue.empty() ? -1.0 : queue.front().time; }
+	size_t GetQueued() const { return queue.size(); }
+
+	const NetSimStats &GetStats() const { return stats; }
+
+   private:
+	struct Packet
+	{
+		double				 time;
+		uint64_t			 order;	 // tie break, keeps equal times in send order
+		uint32_t			 tag;
+		std::vector<uint8_t> data;
+	};
+
+	struct Later
+	{
+		bool operator()(const Packet &a, const Packet &b) const
+		{
+			return a.time != b.time ? a.time > b.time : a.order > b.order;
+		}
+	};
+
+	NetSimConfig		config;
+	uint64_t			state;	// generator
+	uint64_t			order;
+	bool				in_burst;
+	double				link_free;			// when the link finishes the queued packets
+	double				last_in_order;		// delivery time of the latest in order packet
+	std::vector<Packet> queue;				// min-heap on time
+	NetSimStats			stats;
+
+	double Random();  // [0, 1)
+	double Delay(double u, double v) const;	 // seconds, from two draws
+	void   Queue(double time, const uint8_t *data, int bytes, uint32_t tag);
+};
@@ -0,0 +1,239 @@
+#include "net_sim.h"
+
+#include "check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+struct Delivery
+{
+	double	 time;
+	uint32_t tag;
+};
+
+// Sends `count` packets tagged with their index, one per millisecond, and
+// collects the deliveries.
+static std::vector<Delivery> run(NetSimulator &sim, int count, int bytes = 100)
+{
+	std::vector<uint8_t>  packet(bytes);
+	std::vector<Delivery> deliveries;
+	double				  time = 0.0;
+	for (int i = 0; i < count; i++, time += 0.001) {
+		memcpy(packet.data(), &i, sizeof(i));
+		sim.Send(time, packet.data(), bytes, i);
+		sim.Receive(time, [&](const uint8_t *data, int size, uint32_t tag) {
+			CHECK(size == bytes && !memcmp(data, &tag, sizeof(tag)));
+			deliveries.push_back({time, tag});
+		});
+	}
+	while (sim.GetQueued()) {
+		time = std::max(time, sim.GetNextDelivery());
+		sim.Receive(time, [&](const uint8_t *, int, uint32_t tag) { deliveries.push_back({time, tag}); });
+	}
+	return deliveries;
+}
+
+static void test_perfect()
+{
+	NetSimulator sim(NetSimConfig{});
+	auto		 deliveries = run(sim, 100);
+	CHECK(deliveries.size() == 100);
+	for (int i = 0; i < 100; i++) CHECK(deliveries[i].tag == static_cast<uint32_t>(i));
+	CHECK(sim.GetStats().sent == 100 && sim.GetStats().delivered == 100);
+	CHECK(sim.GetNextDelivery() < 0);
+}
+
+static void test_latency()
+{
+	NetSimConfig config;
+	config.latency_ms = 75.0;
+	config.jitter_ms  = 20.0;
+
+	for (auto distribution : {NetSimConfig::Distribution::Constant, NetSimConfig::Distribution::Uniform,
+							  NetSimConfig::Distribution::Normal, NetSimConfig::Distribution::Pareto}) {
+		config.distribution = distribution;
+		NetSimulator		 sim(config);
+		std::vector<uint8_t> packet(10);
+		double				 total = 0.0, low = 1e9, high = 0.0;
+		const int			 count = 4000;
+		for (int i = 0; i < count; i++) {
+			const double sent = i * 1.0;  // far apart, ordering never holds a packet back
+			sim.Send(sent, packet.data(), 10);
+			const double due = sim.GetNextDelivery();
+			CHECK(sim.Receive(due, [](const uint8_t *, int, uint32_t) {}) == 1);
+			const double delay_ms = (due - sent) * 1000.0;
+			total += delay_ms;
+			low	 = std::min(low, delay_ms);
+			high = std::max(high, delay_ms);
+		}
+		const double mean = total / count;
+		switch (distribution) {
+			case NetSimConfig::Distribution::Constant:
+				CHECK(low >= 75.0 - 1e-6 && high < 95.0 && fabs(mean - 85.0) < 1.0);
+				break;
+			case NetSimConfig::Distribution::Uniform:
+				CHECK(low >= 55.0 - 1e-6 && high <= 95.0 + 1e-6 && fabs(mean - 75.0) < 1.0);
+				break;
+			case NetSimConfig::Distribution::Normal: CHECK(fabs(mean - 75.0) < 1.5 && high > 115.0); break;
+			case NetSimConfig::Distribution::Pareto:
+				CHECK(low >= 75.0 - 1e-6 && fabs(mean - 85.0) < 2.0 && high > 150.0);	// scale / (shape - 1) on top
+				break;
+		}
+	}
+}
+
+static void test_order()
+{
+	// Jitter larger than the send interval: still in order.
+	NetSimConfig config;
+	config.latency_ms	= 50.0;
+	config.jitter_ms	= 30.0;
+	config.distribution = NetSimConfig::Distribution::Normal;
+	{
+		NetSimulator sim(config);
+		auto		 deliveries = run(sim, 1000);
+		CHECK(deliveries.size() == 1000);
+		for (int i = 0; i < 1000; i++) CHECK(deliveries[i].tag == static_cast<uint32_t>(i));
+		CHECK(sim.GetStats().reordered == 0);
+	}
+
+	config.reorder = 0.1;
+	NetSimulator sim(config);
+	auto		 deliveries = run(sim, 1000);
+	CHECK(deliveries.size() == 1000);
+	int out_of_order = 0;
+	for (size_t i = 1; i < deliveries.size(); i++) out_of_order += deliveries[i].tag < deliveries[i - 1].tag;
+	CHECK(out_of_order > 50);
+	CHECK(sim.GetStats().reordered > 70 && sim.GetStats().reordered < 130);
+}
+
+static void test_loss()
+{
+	NetSimConfig config;
+	config.loss = 0.05;
+	NetSimulator sim(config);
+	auto		 deliveries = run(sim, 20000);
+	CHECK(sim.GetStats().lost > 800 && sim.GetStats().lost < 1200);
+	CHECK(deliveries.size() == 20000 - sim.GetStats().lost);
+
+	// Bursts: about burst_rate of the packets start one, burst_length long.
+	config				= NetSimConfig{};
+	config.burst_rate	= 0.01;
+	config.burst_length = 5.0;
+	NetSimulator burst(config);
+	std::vector<bool> delivered(20000, false);
+	for (const auto &delivery : run(burst, 20000)) delivered[delivery.tag] = true;
+
+	int bursts = 0, lost = 0;
+	for (size_t i = 0; i < delivered.size(); i++) {
+		if (delivered[i]) continue;
+		lost++;
+		bursts += i == 0 || delivered[i - 1];
+	}
+	CHECK(lost == static_cast<int>(burst.GetStats().burst_lost));
+	const double mean_length = static_cast<double>(lost) / bursts;
+	CHECK(bursts > 120 && bursts < 220);
+	CHECK(mean_length > 4.0 && mean_length < 6.0);
+}
+
+static void test_duplicate()
+{
+	NetSimConfig config;
+	config.latency_ms = 10.0;
+	config.duplicate  = 0.1;
+	NetSimulator sim(config);
+	auto		 deliveries = run(sim, 5000);
+	CHECK(sim.GetStats().duplicated > 400 && sim.GetStats().duplicated < 600);
+	CHECK(deliveries.size() == 5000 + sim.GetStats().duplicated);
+}
+
+static void test_bandwidth()
+{
+	// 80 kbit/s is 10 bytes per millisecond: 100 byte packets take 10 ms each
+	// on the link while one is sent every millisecond.
+	NetSimConfig config;
+	config.bandwidth_kbps = 80.0;
+	config.queue_bytes	  = 1000;
+	NetSimulator sim(config);
+	auto		 deliveries = run(sim, 200);
+
+	CHECK(sim.GetStats().queue_drops > 150);
+	CHECK(deliveries.size() + sim.GetStats().queue_drops == 200);
+	for (size_t i = 1; i < deliveries.size(); i++) CHECK(deliveries[i].time - deliveries[i - 1].time >= 0.01 - 1e-9);
+
+	// Within the rate nothing is dropped.
+	config.bandwidth_kbps = 1000.0;
+	NetSimulator fast(config);
+	CHECK(run(fast, 200).size() == 200);
+	CHECK(fast.GetStats().queue_drops == 0);
+}
+
+static void test_determinism()
+{
+	NetSimConfig config;
+	config.latency_ms	= 60.0;
+	config.jitter_ms	= 15.0;
+	config.distribution = NetSimConfig::Distribution::Pareto;
+	config.loss			= 0.03;
+	config.burst_rate	= 0.005;
+	config.reorder		= 0.02;
+	config.duplicate	= 0.01;
+	config.seed			= 42;
+
+	auto same = [](const std::vector<Delivery> &a, const std::vector<Delivery> &b) {
+		if (a.size() != b.size()) return false;
+		for (size_t i = 0; i < a.size(); i++)
+			if (a[i].tag != b[i].tag || a[i].time != b[i].time) return false;
+		return true;
+	};
+
+	NetSimulator first(config), second(config);
+	auto		 a = run(first, 5000), b = run(second, 5000);
+	CHECK(same(a, b));
+
+	config.seed = 43;
+	NetSimulator other(config);
+	CHECK(!same(a, run(other, 5000)));
+}
+
+static void test_parse()
+{
+	const char *args[] = {"prog", "--net-latency", "75", "--net-loss", "5", "--net-distribution", "pareto",
+						  "--net-seed", "7", "--other", "x", "--net-bogus", "1"};
+	char	  **argv   = const_cast<char **>(args);
+	const int	argc   = sizeof(args) / sizeof(args[0]);
+
+	NetSimConfig config;
+	CHECK(!config.IsActive());
+	int i = 1;
+	CHECK(net_sim_parse_arg(config, argc, argv, i) && i == 2);
+	i++;
+	CHECK(net_sim_parse_arg(config, argc, argv, i));
+	i++;
+	CHECK(net_sim_parse_arg(config, argc, argv, i));
+	i++;
+	CHECK(net_sim_parse_arg(config, argc, argv, i));
+	i++;
+	CHECK(!net_sim_parse_arg(config, argc, argv, i));	// --other
+	i += 2;
+	CHECK(!net_sim_parse_arg(config, argc, argv, i));	// --net-bogus
+
+	CHECK(config.latency_ms == 75.0 && config.loss == 0.05 && config.seed == 7);
+	CHECK(config.distribution == NetSimConfig::Distribution::Pareto);
+	CHECK(config.IsActive());
+}
+
+int main()
+{
+	test_perfect();
+	test_latency();
+	test_order();
+	test_loss();
+	test_duplicate();
+	test_bandwidth();
+	test_determinism();
+	test_parse();
+	printf("net_sim_test: ok\n");
+	return 0;
+}
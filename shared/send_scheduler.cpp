@@ -0,0 +1,154 @@
+#include "send_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// --- Bandwidth Estimator -------------------------------------------------
+
+BandwidthEstimator::BandwidthEstimator(const Config &config)
+	: config{config}
+{
+	Reset();
+}
+
+void BandwidthEstimator::Reset()
+{
+	estimate	  = config.initial_kbps;
+	min_rtt		  = 0.0f;
+	last_decrease = -1.0e9;
+	congested	  = false;
+}
+
+void BandwidthEstimator::Update(const LinkStats &stats, double time)
+{
+	if (stats.rtt > 0.0f) {
+		if (min_rtt <= 0.0f || stats.rtt < min_rtt)
+			min_rtt = stats.rtt;
+		else  // let the baseline follow route changes slowly
+			min_rtt += (stats.rtt - min_rtt) * 0.001f;
+	}
+
+	const bool lossy	= stats.packet_loss > config.loss_threshold;
+	const bool inflated = min_rtt > 0.0f && stats.rtt > min_rtt * config.rtt_inflation + config.rtt_inflation_slop;
+	congested			= lossy || inflated;
+
+	if (congested) {
+		// React at most once per round trip, the stats lag behind by about that much.
+		const double reaction_time = std::max(0.05, stats.rtt / 1000.0);
+		if (time - last_decrease >= reaction_time) {
+			estimate *= config.decrease_factor;
+			last_decrease = time;
+		}
+	}
+	else if (stats.sent_bandwidth >= estimate * 0.5f) {
+		// Only probe for more when we are actually using what we have.
+		estimate += config.increase_kbps;
+	}
+
+	estimate = std::clamp(estimate, config.min_kbps, config.max_kbps);
+}
+
+int BandwidthEstimator::GetTickBudget(double tick_seconds) const
+{
+	return static_cast<int>(estimate * 1000.0 / 8.0 * tick_seconds);
+}
+
+// --- Send Scheduler ------------------------------------------------------
+
+SendScheduler::SendScheduler(int max_clients, const Config &config)
+	: config{config}
+{
+	clients.resize(max_clients);
+	for (auto &client : clients) {
+		client.estimator		 = BandwidthEstimator(config.estimator);
+		client.tick_budget		 = 0;
+		client.credit			 = 0;
+		client.snapshot_bytes	 = 0.0f;
+		client.snapshot_interval = 1;
+	}
+}
+
+void SendScheduler::Enqueue(int client, const OutgoingMessage &message, const DropFunction &drop)
+{
+	auto &state = clients[client];
+	auto &queue = state.queues[static_cast<int>(message.priority)];
+
+	if (message.snapshot) {
+		// A newer snapshot makes any queued one worthless.
+		for (auto it = queue.begin(); it != queue.end();) {
+			if (it->snapshot) {
+				drop(client, *it);
+				it = queue.erase(it);
+			}
+			else
+				++it;
+		}
+
+		if (state.snapshot_bytes <= 0.0f)
+			state.snapshot_bytes = static_cast<float>(message.bytes);
+		else
+			state.snapshot_bytes += (message.bytes - state.snapshot_bytes) * 0.1f;
+	}
+
+	queue.push_back(message);
+}
+
+void SendScheduler::Update(int client, const LinkStats &stats, double time, double tick_seconds)
+{
+	auto &state = clients[client];
+
+	state.estimator.Update(stats, time);
+	state.tick_budget = state.estimator.GetTickBudget(tick_seconds);
+	state.credit	  = std::min(state.credit + state.tick_budget, state.tick_budget * config.max_burst_ticks);
+
+	// Degrade the snapshot rate until the snapshots fit into their share of the budget.
+	const float snapshot_budget = state.tick_budget * config.snapshot_share;
+	int			interval		= 1;
+	if (state.snapshot_bytes > 0.0f && snapshot_budget > 0.0f)
+		interval = static_cast<int>(std::ceil(state.snapshot_bytes / snapshot_budget));
+	state.snapshot_interval = std::clamp(interval, 1, config.max_snapshot_interval);
+}
+
+void SendScheduler::Flush(int client, const SendFunction &send)
+{
+	auto &state = clients[client];
+
+	for (auto &queue : state.queues) {
+		while (!queue.empty()) {
+			const auto &message = queue.front();
+			// A message larger than the remaining credit still goes out and puts
+			// the client into debt, so big messages cannot be starved forever.
+			if (message.priority != SendPriority::Critical && state.credit <= 0) return;
+			if (!send(client, message)) break;	// channel full, try lower priorities
+			state.credit -= message.bytes;
+			queue.pop_front();
+		}
+	}
+}
+
+void SendScheduler::Clear(int client, const DropFunction &drop)
+{
+	auto &state = clients[client];
+
+	for (auto &queue : state.queues) {
+		for (const auto &message : queue) drop(client, message);
+		queue.clear();
+	}
+	state.estimator.Reset();
+	state.tick_budget		= 0;
+	state.credit			= 0;
+	state.snapshot_bytes	= 0.0f;
+	state.snapshot_interval = 1;
+}
+
+bool SendScheduler::ShouldSendSnapshot(int client, uint64_t tick) const
+{
+	return tick % static_cast<uint64_t>(clients[client].snapshot_interval) == 0;
+}
+
+size_t SendScheduler::GetQueueDepth(int client) const
+{
+	size_t depth = 0;
+	for (const auto &queue : clients[client].queues) depth += queue.size();
+	return depth;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Link statistics as reported by the transport (yojimbo::NetworkInfo).
+struct LinkStats
+{
+	float rtt;				// round trip time, milliseconds
+	float packet_loss;		// percent
+	float sent_bandwidth;	// kbps
+	float acked_bandwidth;	// kbps
+};
+
+// Congestion-aware estimate of the bandwidth available to a single client.
+//
+// Additive increase while the link keeps up, multiplicative decrease (at most
+// once per round trip) when packet loss or RTT inflation signals congestion.
+class BandwidthEstimator
+{
+   public:
+	struct Config
+	{
+		float min_kbps			 = 32.0f;
+		float max_kbps			 = 2048.0f;
+		float initial_kbps		 = 256.0f;
+		float increase_kbps		 = 8.0f;   // per update while not congested
+		float decrease_factor	 = 0.7f;   // applied on congestion
+		float loss_threshold	 = 2.0f;   // percent
+		float rtt_inflation		 = 2.0f;   // rtt above min_rtt * this is congestion
+		float rtt_inflation_slop = 20.0f;  // milliseconds, ignore jitter below this
+	};
+
+	BandwidthEstimator() : BandwidthEstimator(Config{}) {}
+	explicit BandwidthEstimator(const Config &config);
+
+	void Reset();
+	void Update(const LinkStats &stats, double time);
+
+	float GetEstimate() const { return estimate; }	// kbps
+	int	  GetTickBudget(double tick_seconds) const;	 // bytes
+	bool  IsCongested() const { return congested; }
+
+   private:
+	Config config;
+	float  estimate;
+	float  min_rtt;
+	double last_decrease;
+	bool   congested;
+};
+
+enum class SendPriority : uint8_t {
+	Critical,  // never held back by the budget (connection control, acks)
+	High,	   // gameplay events
+	Normal,
+	Low,  // chat, cosmetics
+	Count
+};
+
+struct OutgoingMessage
+{
+	void		*message;  // transport-owned message, opaque to the scheduler
+	int			 bytes;	   // estimated serialized size
+	int			 channel;
+	SendPriority priority;
+	bool		 snapshot;	// superseded by any newer snapshot for the same client
+};
+
+// Per-client priority queues drained against a per-tick byte budget.
+//
+// The transport stays outside: messages are handed back through SendFunction
+// (returning false when the channel cannot take more this tick) and
+// DropFunction (for superseded snapshots and queues of departed clients).
+class SendScheduler
+{
+   public:
+	using SendFunction = std::function<bool(int client, const OutgoingMessage &message)>;
+	using DropFunction = std::function<void(int client, const OutgoingMessage &message)>;
+
+	struct Config
+	{
+		BandwidthEstimator::Config estimator;
+		float					   snapshot_share		 = 0.6f;  // fraction of the budget snapshots may use
+		int						   max_snapshot_interval = 8;	  // in ticks
+		int						   max_burst_ticks		 = 2;	  // unused budget carried over
+	};
+
+	explicit SendScheduler(int max_clients) : SendScheduler(max_clients, Config{}) {}
+	SendScheduler(int max_clients, const Config &config);
+
+	void Enqueue(int client, const OutgoingMessage &message, const DropFunction &drop);
+	void Update(int client, const LinkStats &stats, double time, double tick_seconds);
+	void Flush(int client, const SendFunction &send);
+	void Clear(int client, const DropFunction &drop);
+
+	// Whether a snapshot should be generated for the client on this tick.
+	bool ShouldSendSnapshot(int client, uint64_t tick) const;
+
+	size_t GetQueueDepth(int client) const;
+	int	   GetSnapshotInterval(int client) const { return clients[client].snapshot_interval; }
+	int	   GetTickBudget(int client) const { return clients[client].tick_budget; }
+	const BandwidthEstimator &GetEstimator(int client) const { return clients[client].estimator; }
+
+   private:
+	struct ClientState
+	{
+		BandwidthEstimator			estimator;
+		std::deque<OutgoingMessage> queues[static_cast<int>(SendPriority::Count)];
+		int							tick_budget;
+		int							credit;	 // bytes available this tick, may go negative
+		float						snapshot_bytes;	 // running average
+		int							snapshot_interval;
+	};
+
+	Config					 config;
+	std::vector<ClientState> clients;
+};
@@ -0,0 +1,180 @@
+#include "send_scheduler.h"
+
+#include "check.h"
+
+#include <cstdio>
+#include <vector>
+
+// Local stand-in for the transport: a bottleneck link with a bounded queue.
+// Whatever does not fit into the queue is lost, queued bytes inflate the RTT.
+class LossyLink
+{
+	float	 capacity_kbps;
+	float	 base_rtt;
+	float	 random_loss;  // percent
+	int		 queue_limit;  // bytes
+	int		 queued;
+	uint32_t seed;
+
+	float rtt, packet_loss, sent_bandwidth, acked_bandwidth;
+
+	float random()
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return (seed >> 8) / float(1 << 24);
+	}
+
+   public:
+	LossyLink(float capacity_kbps, float base_rtt, float random_loss)
+		: capacity_kbps{capacity_kbps},
+		  base_rtt{base_rtt},
+		  random_loss{random_loss},
+		  queue_limit{static_cast<int>(capacity_kbps * 1000 / 8 * 0.1)},	// 100 ms worth
+		  queued{0},
+		  seed{1},
+		  rtt{base_rtt},
+		  packet_loss{0},
+		  sent_bandwidth{0},
+		  acked_bandwidth{0}
+	{
+	}
+
+	void Transmit(const std::vector<int> &packets, double tick_seconds)
+	{
+		int offered = 0, dropped = 0;
+		for (int bytes : packets) {
+			offered += bytes;
+			if (random() * 100.0f < random_loss || queued + bytes > queue_limit)
+				dropped += bytes;
+			else
+				queued += bytes;
+		}
+
+		const int capacity	= static_cast<int>(capacity_kbps * 1000 / 8 * tick_seconds);
+		const int delivered = queued < capacity ? queued : capacity;
+		queued -= delivered;
+
+		// Smoothed like yojimbo's NetworkInfo.
+		const float sample_rtt	= base_rtt + queued * 1000.0f / (capacity_kbps * 1000 / 8);
+		const float sample_loss = offered ? dropped * 100.0f / offered : 0.0f;
+		rtt += (sample_rtt - rtt) * 0.1f;
+		packet_loss += (sample_loss - packet_loss) * 0.1f;
+		sent_bandwidth += (offered * 8 / 1000.0f / tick_seconds - sent_bandwidth) * 0.1f;
+		acked_bandwidth += (delivered * 8 / 1000.0f / tick_seconds - acked_bandwidth) * 0.1f;
+	}
+
+	LinkStats GetStats() const { return {rtt, packet_loss, sent_bandwidth, acked_bandwidth}; }
+};
+
+static const double tick = 0.01;
+
+static void noop_drop(int, const OutgoingMessage &) {}
+
+// Runs a saturating sender against the link and returns the average estimate
+// over the last simulated second.
+static float saturate(LossyLink &link, SendScheduler &scheduler, int seconds)
+{
+	double time	   = 0.0;
+	float  average = 0.0f;
+	int	   ticks   = seconds * static_cast<int>(1 / tick);
+
+	for (int i = 0; i < ticks; ++i) {
+		while (scheduler.GetQueueDepth(0) < 64)
+			scheduler.Enqueue(0, {nullptr, 200, 0, SendPriority::Normal, false}, noop_drop);
+
+		scheduler.Update(0, link.GetStats(), time, tick);
+
+		std::vector<int> packets;
+		scheduler.Flush(0, [&](int, const OutgoingMessage &message) {
+			packets.push_back(message.bytes);
+			return true;
+		});
+		link.Transmit(packets, tick);
+
+		if (i >= ticks - 100) average += scheduler.GetEstimator(0).GetEstimate() / 100;
+		time += tick;
+	}
+	return average;
+}
+
+static void test_converges_to_capacity()
+{
+	LossyLink	  link(200.0f, 50.0f, 0.0f);
+	SendScheduler scheduler(1);
+
+	float estimate = saturate(link, scheduler, 30);
+	CHECK(estimate > 100.0f && estimate < 300.0f);
+	CHECK(link.GetStats().packet_loss < 5.0f);
+}
+
+static void test_backs_off_under_random_loss()
+{
+	LossyLink	  clean(1000.0f, 50.0f, 0.0f);
+	LossyLink	  lossy(1000.0f, 50.0f, 5.0f);
+	SendScheduler clean_scheduler(1), lossy_scheduler(1);
+
+	float clean_estimate = saturate(clean, clean_scheduler, 20);
+	float lossy_estimate = saturate(lossy, lossy_scheduler, 20);
+	CHECK(lossy_estimate < clean_estimate);
+}
+
+static void test_priority_order()
+{
+	SendScheduler scheduler(1);
+	scheduler.Update(0, {50.0f, 0.0f, 0.0f, 0.0f}, 0.0, tick);
+	int budget = scheduler.GetTickBudget(0);
+
+	scheduler.Enqueue(0, {nullptr, budget, 0, SendPriority::Low, false}, noop_drop);
+	scheduler.Enqueue(0, {nullptr, budget, 0, SendPriority::High, false}, noop_drop);
+	scheduler.Enqueue(0, {nullptr, 100, 0, SendPriority::Critical, false}, noop_drop);
+
+	std::vector<SendPriority> sent;
+	auto					  send = [&](int, const OutgoingMessage &message) {
+		 sent.push_back(message.priority);
+		 return true;
+	};
+
+	scheduler.Flush(0, send);
+	CHECK(sent.size() == 2);
+	CHECK(sent[0] == SendPriority::Critical && sent[1] == SendPriority::High);
+	CHECK(scheduler.GetQueueDepth(0) == 1);
+
+	scheduler.Update(0, {50.0f, 0.0f, 0.0f, 0.0f}, tick, tick);
+	scheduler.Update(0, {50.0f, 0.0f, 0.0f, 0.0f}, 2 * tick, tick);
+	scheduler.Flush(0, send);
+	CHECK(sent.size() == 3 && sent[2] == SendPriority::Low);
+}
+
+static void test_snapshot_rate_degrades()
+{
+	SendScheduler::Config config;
+	config.estimator.initial_kbps = 32.0f;
+	SendScheduler slow(1, config);
+	config.estimator.initial_kbps = 1024.0f;
+	SendScheduler fast(1, config);
+
+	int dropped = 0;
+	for (auto *scheduler : {&slow, &fast}) {
+		for (int i = 0; i < 3; ++i)
+			scheduler->Enqueue(0, {nullptr, 400, 1, SendPriority::Normal, true}, [&](int, const OutgoingMessage &) { ++dropped; });
+		scheduler->Update(0, {50.0f, 0.0f, 0.0f, 0.0f}, 0.0, tick);
+		CHECK(scheduler->GetQueueDepth(0) == 1);
+	}
+	CHECK(dropped == 4);
+
+	CHECK(slow.GetSnapshotInterval(0) > 1);
+	CHECK(!slow.ShouldSendSnapshot(0, 1));
+	CHECK(fast.GetSnapshotInterval(0) == 1);
+	CHECK(fast.ShouldSendSnapshot(0, 1));
+}
+
+int main()
+{
+	test_converges_to_capacity();
+	test_backs_off_under_random_loss();
+	test_priority_order();
+	test_snapshot_rate_degrades();
+
+	printf("send_scheduler: all tests passed\n");
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include "spatial_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+static uint64_t cell_key(int x, int y)
+{
+	return static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32 | static_cast<uint32_t>(y);
+}
+
+SpatialGrid::SpatialGrid(float cell_size)
+	: cell_size{cell_size},
+	  count{0},
+	  query_stamp{0}
+{
+}
+
+SpatialGrid::CellRange SpatialGrid::RangeOf(const GridRect &bounds) const
+{
+	return {static_cast<int>(std::floor(bounds.x / cell_size)), static_cast<int>(std::floor(bounds.y / cell_size)),
+			static_cast<int>(std::floor((bounds.x + bounds.width) / cell_size)),
+			static_cast<int>(std::floor((bounds.y + bounds.height) / cell_size))};
+}
+
+void SpatialGrid::Link(int id, const CellRange &range)
+{
+	for (int y = range.y0; y <= range.y1; y++)
+		for (int x = range.x0; x <= range.x1; x++) cells[cell_key(x, y)].push_back(id);
+}
+
+void SpatialGrid::Unlink(int id, const CellRange &range)
+{
+	for (int y = range.y0; y <= range.y1; y++)
+		for (int x = range.x0; x <= range.x1; x++) {
+			auto cell = cells.find(cell_key(x, y));
+			if (cell == cells.end()) continue;
+
+			auto &ids = cell->second;
+			auto  it  = std::find(ids.begin(), ids.end(), id);
+			if (it != ids.end()) {
+				*it = ids.back();
+				ids.pop_back();
+			}
+			if (ids.empty()) cells.erase(cell);
+		}
+}
+
+void SpatialGrid::Insert(int id, const GridRect &bounds)
+{
+	if (id >= static_cast<int>(items.size())) items.resize(id + 1, Item{{}, {}, 0, false});
+	if (items[id].present) {
+		Update(id, bounds);
+		return;
+	}
+
+	const CellRange range = RangeOf(bounds);
+	items[id]			  = Item{bounds, range, query_stamp, true};
+	Link(id, range);
+	count++;
+}
+
+void SpatialGrid::Update(int id, const GridRect &bounds)
+{
+	auto &item = items[id];
+	item.bounds = bounds;
+
+	const CellRange range = RangeOf(bounds);
+	if (range == item.cells) return;
+
+	Unlink(id, item.cells);
+	Link(id, range);
+	item.cells = range;
+}
+
+void SpatialGrid::Remove(int id)
+{
+	if (id >= static_cast<int>(items.size()) || !items[id].present) return;
+
+	Unlink(id, items[id].cells);
+	items[id].present = false;
+	count--;
+}
+
+void SpatialGrid::Clear()
+{
+	items.clear();
+	cells.clear();
+	count = 0;
+}
+
+void SpatialGrid::Query(const GridRect &area, std::vector<int> &out)
+{
+	// Items spanning several cells are seen once per cell, the stamp
+	// reports them once.
+	if (++query_stamp == 0) {
+		for (auto &item : items) item.stamp = 0;
+		query_stamp = 1;
+	}
+
+	const CellRange range = RangeOf(area);
+	for (int y = range.y0; y <= range.y1; y++)
+		for (int x = range.x0; x <= range.x1; x++) {
+			auto cell = cells.find(cell_key(x, y));
+			if (cell == cells.end()) continue;
+
+			for (int id : cell->second) {
+				auto &item = items[id];
+				if (item.stamp == query_stamp) continue;
+				item.stamp = query_stamp;
+
+				const auto &bounds = item.bounds;
+				if (bounds.x + bounds.width < area.x || bounds.x > area.x + area.width || bounds.y + bounds.height < area.y
+					|| bounds.y > area.y + area.height)
+					continue;
+				out.push_back(id);
+			}
+		}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct GridRect
+{
+	float x, y, width, height;
+};
+
+// Uniform grid over an unbounded plane, for visibility and proximity
+// queries over many small moving items.
+//
+// Items are kept in every cell their bounds overlap; Update() only touches
+// the cells when the covered cell range changes, which for items smaller
+// than a cell is rare. Query() reports each item once.
+class SpatialGrid
+{
+   public:
+	explicit SpatialGrid(float cell_size = 128.0f);
+
+	void Insert(int id, const GridRect &bounds);
+	void Update(int id, const GridRect &bounds);
+	void Remove(int id);
+	void Clear();
+
+	// Appends ids of items whose bounds overlap `area` to `out`.
+	void Query(const GridRect &area, std::vector<int> &out);
+
+	int	  GetCount() const { return count; }
+	float GetCellSize() const { return cell_size; }
+
+   private:
+	struct CellRange
+	{
+		int x0, y0, x1, y1;
+		bool operator==(const CellRange &other) const
+		{
+			return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+		}
+	};
+
+	struct Item
+	{
+		GridRect  bounds;
+		CellRange cells;
+		uint32_t  stamp;  // last query that reported the item
+		bool	  present;
+	};
+
+	float										 cell_size;
+	int											 count;
+	std::vector<Item>							 items;	 // by id
+	std::unordered_map<uint64_t, std::vector<int>> cells;
+	uint32_t									 query_stamp;
+
+	CellRange RangeOf(const GridRect &bounds) const;
+	void	  Link(int id, const CellRange &range);
+	void	  Unlink(int id, const CellRange &range);
+};
@@ -0,0 +1,95 @@
+#include "spatial_grid.h"
+
+#include "check.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static std::vector<int> query(SpatialGrid &grid, const GridRect &area)
+{
+	std::vector<int> found;
+	grid.Query(area, found);
+	std::sort(found.begin(), found.end());
+	return found;
+}
+
+static void test_query()
+{
+	SpatialGrid grid(100.0f);
+	grid.Insert(0, {10, 10, 20, 20});
+	grid.Insert(1, {150, 10, 20, 20});
+	grid.Insert(2, {-50, -50, 20, 20});	 // negative cells
+	grid.Insert(3, {90, 90, 30, 30});	 // spans four cells
+	CHECK(grid.GetCount() == 4);
+
+	CHECK(query(grid, {0, 0, 100, 100}) == (std::vector<int>{0, 3}));
+	CHECK(query(grid, {-100, -100, 400, 400}) == (std::vector<int>{0, 1, 2, 3}));
+	CHECK(query(grid, {115, 115, 10, 10}) == (std::vector<int>{3}));
+	CHECK(query(grid, {40, 40, 10, 10}).empty());	// same cell, no overlap
+	CHECK(query(grid, {1000, 1000, 10, 10}).empty());
+}
+
+static void test_update()
+{
+	SpatialGrid grid(100.0f);
+	grid.Insert(5, {10, 10, 10, 10});
+
+	grid.Update(5, {20, 20, 10, 10});  // within the cell
+	CHECK(query(grid, {15, 15, 10, 10}) == (std::vector<int>{5}));
+
+	grid.Update(5, {510, 510, 10, 10});
+	CHECK(query(grid, {0, 0, 100, 100}).empty());
+	CHECK(query(grid, {500, 500, 50, 50}) == (std::vector<int>{5}));
+
+	grid.Insert(5, {10, 10, 10, 10});  // existing ids move
+	CHECK(grid.GetCount() == 1);
+	CHECK(query(grid, {0, 0, 100, 100}) == (std::vector<int>{5}));
+
+	grid.Remove(5);
+	grid.Remove(5);
+	CHECK(grid.GetCount() == 0);
+	CHECK(query(grid, {-1000, -1000, 2000, 2000}).empty());
+
+	grid.Insert(5, {10, 10, 10, 10});
+	grid.Clear();
+	CHECK(grid.GetCount() == 0);
+	CHECK(query(grid, {0, 0, 100, 100}).empty());
+}
+
+// Moving items against a brute force overlap test.
+static void test_random()
+{
+	SpatialGrid			  grid(64.0f);
+	std::vector<GridRect> rects(500);
+	unsigned			  seed = 1;
+	auto				  next = [&] { return (seed = seed * 1103515245 + 12345) >> 16 & 0x7fff; };
+
+	for (int step = 0; step < 20; step++) {
+		for (int id = 0; id < static_cast<int>(rects.size()); id++) {
+			rects[id] = {static_cast<float>(next() % 2000) - 1000, static_cast<float>(next() % 2000) - 1000,
+						 static_cast<float>(next() % 100), static_cast<float>(next() % 100)};
+			if (step == 0) grid.Insert(id, rects[id]);
+			else grid.Update(id, rects[id]);
+		}
+
+		const GridRect	 area{static_cast<float>(next() % 1000) - 500, static_cast<float>(next() % 1000) - 500, 400, 300};
+		std::vector<int> expected;
+		for (int id = 0; id < static_cast<int>(rects.size()); id++) {
+			const auto &r = rects[id];
+			if (r.x + r.width < area.x || r.x > area.x + area.width || r.y + r.height < area.y
+				|| r.y > area.y + area.height)
+				continue;
+			expected.push_back(id);
+		}
+		CHECK(query(grid, area) == expected);
+	}
+}
+
+int main()
+{
+	test_query();
+	test_update();
+	test_random();
+	printf("spatial_grid_test: ok\n");
+	return 0;
+}
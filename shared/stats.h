@@ -0,0 +1,19 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+struct Percentiles
+{
+	double p50, p90, p99, max;
+};
+
+// Nearest-rank percentiles, sorts the samples in place.
+inline Percentiles compute_percentiles(std::vector<double> &samples)
+{
+	if (samples.empty()) return {0, 0, 0, 0};
+
+	std::sort(samples.begin(), samples.end());
+	auto rank = [&](double p) { return samples[static_cast<size_t>(p * (samples.size() - 1) + 0.5)]; };
+	return {rank(0.50), rank(0.90), rank(0.99), samples.back()};
+}